@@ -0,0 +1,645 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 16 Oct 2026
+
+    Headless benchmarks for the processing engine.
+
+    MBCompBenchmarks [--processor] [--json <file>] [--label <text>]
+    MBCompBenchmarks --rt-check [--seed <n>] [--scenarios <n>] [--abort]
+    MBCompBenchmarks --meter-check
+
+    --processor     only the processBlock sweep, skips the component benchmarks
+    --json <file>   also writes the processBlock sweep to <file>, for comparing commits
+    --label <text>  stored in the json, eg. the commit being measured
+    --rt-check      fails (exit code 1) if processBlock allocates or locks, see RealtimeCheck.h.
+                    --abort stops at the first violation with a core dump
+    --meter-check   fails (exit code 1) if a processed block never reaches the meters, or
+                    reaches them twice
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/Compressor.h"
+#include "../../Source/Crossover.h"
+#include "../../Source/LinearPhaseCrossover.h"
+#include "../../Source/WorkerPool.h"
+#include "../../Source/PluginProcessor.h"
+#include "RealtimeCheck.h"
+
+namespace
+{
+
+constexpr double sampleRate = 48000.0;
+constexpr int numChannels = 2;
+constexpr int blockSize = 512;
+constexpr int numSamples = static_cast<int>(sampleRate) * 10;
+constexpr int numRuns = 5;
+
+// fastest of numRuns passes over the whole signal, in samples (per channel) per second
+template<typename Fn>
+double measure(Fn&& processSignal)
+{
+    auto best = std::numeric_limits<double>::max();
+    
+    for ( auto run = 0; run < numRuns; ++run )
+    {
+        auto start = juce::Time::getHighResolutionTicks();
+        processSignal();
+        auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+        
+        best = juce::jmin(best, seconds);
+    }
+    
+    return numSamples / best;
+}
+
+juce::AudioBuffer<float> makeNoise(float levelDb)
+{
+    juce::AudioBuffer<float> noise(numChannels, numSamples);
+    juce::Random random(0x5eed);
+    
+    auto gain = juce::Decibels::decibelsToGain(levelDb);
+    
+    for ( auto ch = 0; ch < numChannels; ++ch )
+        for ( auto i = 0; i < numSamples; ++i )
+            noise.setSample(ch, i, gain * (random.nextFloat() * 2.f - 1.f));
+    
+    return noise;
+}
+
+//==============================================================================
+void benchmarkCompressors()
+{
+    juce::dsp::ProcessSpec spec { sampleRate, static_cast<juce::uint32>(blockSize), static_cast<juce::uint32>(numChannels) };
+    
+    struct Scenario
+    {
+        const char* name;
+        float signalDb, thresholdDb, kneeDb;
+        CompressorBase::Detector detector;
+    };
+    
+    const Scenario scenarios[] =
+    {
+        { "compressing, peak",      -6.f,  -24.f, 0.f, CompressorBase::Detector::Peak },
+        { "compressing, rms, knee", -6.f,  -24.f, 6.f, CompressorBase::Detector::RMS },
+        { "under threshold",        -30.f, -12.f, 0.f, CompressorBase::Detector::Peak }
+    };
+    
+    std::cout << "Compressor, " << numChannels << " ch @ " << sampleRate << " Hz, " << blockSize << " sample blocks" << std::endl;
+    std::cout << "(samples per second per channel, best of " << numRuns << ")" << std::endl << std::endl;
+    
+    for ( const auto& scenario : scenarios )
+    {
+        auto source = makeNoise(scenario.signalDb);
+        juce::AudioBuffer<float> buffer(numChannels, numSamples);
+        
+        juce::dsp::Compressor<float> juceCompressor;
+        juceCompressor.prepare(spec);
+        juceCompressor.setThreshold(scenario.thresholdDb);
+        juceCompressor.setRatio(4.f);
+        juceCompressor.setAttack(5.f);
+        juceCompressor.setRelease(100.f);
+        
+        auto juceRate = measure([&]
+        {
+            buffer.makeCopyOf(source, true);
+            
+            for ( auto start = 0; start < numSamples; start += blockSize )
+            {
+                auto block = juce::dsp::AudioBlock<float>(buffer).getSubBlock(static_cast<size_t>(start), static_cast<size_t>(blockSize));
+                juceCompressor.process(juce::dsp::ProcessContextReplacing<float>(block));
+            }
+        });
+        
+        Compressor<float> compressor;
+        compressor.prepare(spec);
+        compressor.setThreshold(scenario.thresholdDb);
+        compressor.setRatio(4.f);
+        compressor.setAttack(5.f);
+        compressor.setRelease(100.f);
+        compressor.setKnee(scenario.kneeDb);
+        compressor.setDetector(scenario.detector);
+        
+        auto rate = measure([&]
+        {
+            buffer.makeCopyOf(source, true);
+            
+            for ( auto start = 0; start < numSamples; start += blockSize )
+            {
+                float* channels[numChannels];
+                for ( auto ch = 0; ch < numChannels; ++ch )
+                    channels[ch] = buffer.getWritePointer(ch, start);
+                
+                compressor.process(channels, numChannels, blockSize);
+            }
+        });
+        
+        std::cout << juce::String(scenario.name).paddedRight(' ', 24)
+                  << "juce::dsp::Compressor " << juce::String(juceRate / 1.0e6, 1) << " M/s   "
+                  << "Compressor " << juce::String(rate / 1.0e6, 1) << " M/s   "
+                  << "x" << juce::String(rate / juceRate, 2) << std::endl;
+    }
+}
+
+//==============================================================================
+// channels are compressed in SIMD register wide batches, so the cost per channel should
+// drop as the bus gets wider - and again when channels are linked and share a detector
+void benchmarkChannelCounts()
+{
+    const int channelCounts[] = { 1, 2, 6, 8, 12, 16 };
+    
+    std::cout << std::endl << "Compressor channel batching @ " << sampleRate << " Hz, " << blockSize << " sample blocks" << std::endl << std::endl;
+    
+    for ( auto channels : channelCounts )
+    {
+        juce::AudioBuffer<float> source(channels, numSamples), buffer(channels, numSamples);
+        juce::Random random(0x5eed);
+        
+        for ( auto ch = 0; ch < channels; ++ch )
+            for ( auto i = 0; i < numSamples; ++i )
+                source.setSample(ch, i, 0.5f * (random.nextFloat() * 2.f - 1.f));
+        
+        auto rateWithGroups = [&](const std::vector<int>& groups)
+        {
+            Compressor<float> compressor;
+            compressor.prepare({ sampleRate, static_cast<juce::uint32>(blockSize), static_cast<juce::uint32>(channels) });
+            compressor.setThreshold(-24.f);
+            compressor.setRatio(4.f);
+            compressor.setChannelGroups(groups);
+            
+            return measure([&]
+            {
+                buffer.makeCopyOf(source, true);
+                
+                for ( auto start = 0; start < numSamples; start += blockSize )
+                {
+                    std::array<float*, 16> pointers;
+                    for ( auto ch = 0; ch < channels; ++ch )
+                        pointers[static_cast<size_t>(ch)] = buffer.getWritePointer(ch, start);
+                    
+                    compressor.process(pointers.data(), channels, blockSize);
+                }
+            }) * channels;
+        };
+        
+        std::vector<int> independent(static_cast<size_t>(channels)), linked(static_cast<size_t>(channels), 0);
+        for ( auto ch = 0; ch < channels; ++ch )
+            independent[static_cast<size_t>(ch)] = ch;
+        
+        std::cout << juce::String(channels).paddedLeft(' ', 2) << " ch   "
+                  << "independent " << juce::String(rateWithGroups(independent) / 1.0e6, 1) << " M ch-samples/s   "
+                  << "linked " << juce::String(rateWithGroups(linked) / 1.0e6, 1) << " M ch-samples/s" << std::endl;
+    }
+}
+
+//==============================================================================
+// time per host block against the real time budget, the worst block is what decides dropouts
+template<typename CrossoverType, typename SampleType = float>
+void benchmarkCrossoverBudget(const char* name, double rate, int hostBlock)
+{
+    constexpr size_t numBands = 3;
+    
+    auto totalSamples = static_cast<int>(rate) * 10;
+    auto numBlocks = totalSamples / hostBlock;
+    
+    juce::AudioBuffer<SampleType> input(numChannels, hostBlock);
+    std::array<juce::AudioBuffer<SampleType>, numBands> bands;
+    for ( auto& band : bands )
+        band.setSize(numChannels, hostBlock);
+    
+    // set before preparing, so neither crossover starts with a glide or a kernel rebuild
+    auto crossover = std::make_unique<CrossoverType>();
+    crossover->setCrossoverFrequency(0, 400.f);
+    crossover->setCrossoverFrequency(1, 2000.f);
+    crossover->prepare({ rate, static_cast<juce::uint32>(hostBlock), static_cast<juce::uint32>(numChannels) });
+    
+    juce::Random random(0x5eed);
+    auto total = 0.0, worst = 0.0;
+    
+    for ( auto block = 0; block < numBlocks; ++block )
+    {
+        for ( auto ch = 0; ch < numChannels; ++ch )
+            for ( auto i = 0; i < hostBlock; ++i )
+                input.setSample(ch, i, static_cast<SampleType>(random.nextFloat() * 2.f - 1.f));
+        
+        auto start = juce::Time::getHighResolutionTicks();
+        crossover->process(input, bands, hostBlock);
+        auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+        
+        total += seconds;
+        worst = juce::jmax(worst, seconds);
+    }
+    
+    auto budget = hostBlock / rate;
+    
+    std::cout << juce::String(name).paddedRight(' ', 24)
+              << "mean " << juce::String(1.0e6 * total / numBlocks, 2) << " us   "
+              << "worst " << juce::String(1.0e6 * worst, 2) << " us   "
+              << "budget " << juce::String(1.0e6 * budget, 2) << " us ("
+              << juce::String(100.0 * total / numBlocks / budget, 1) << "% mean)" << std::endl;
+}
+
+void benchmarkCrossovers()
+{
+    constexpr double rate = 96000.0;
+    constexpr int hostBlock = 64;
+    
+    std::cout << std::endl << "Crossover, 3 bands, " << numChannels << " ch @ " << rate << " Hz, " << hostBlock << " sample blocks" << std::endl << std::endl;
+    
+    benchmarkCrossoverBudget<Crossover<3>>("IIR", rate, hostBlock);
+    benchmarkCrossoverBudget<LinearPhaseCrossover<3>>("linear phase", rate, hostBlock);
+    benchmarkCrossoverBudget<Crossover<3, double>, double>("IIR, double", rate, hostBlock);
+    benchmarkCrossoverBudget<LinearPhaseCrossover<3>, double>("linear phase, double", rate, hostBlock);
+}
+
+//==============================================================================
+// 3 compressed bands per block, inline vs. spread over the worker pool, for growing
+// block sizes - the first size where the pool wins is where minParallelWork should sit
+void benchmarkBandDispatch()
+{
+    constexpr int numBands = 3;
+    const int blockSizes[] = { 16, 32, 64, 128, 256, 512, 1024, 2048 };
+    const int channelCounts[] = { 2, 8 };
+    
+    std::cout << std::endl << "Band dispatch, " << numBands << " bands @ " << sampleRate << " Hz, "
+              << juce::SystemStats::getNumCpus() << " cpus" << std::endl << std::endl;
+    
+    WorkerPool pool;
+    pool.start(numBands - 1);
+    
+    for ( auto channels : channelCounts )
+    {
+        auto crossoverPoint = 0;
+        
+        for ( auto size : blockSizes )
+        {
+            std::array<juce::AudioBuffer<float>, numBands> bands;
+            std::array<Compressor<float>, numBands> compressors;
+            
+            juce::Random random(0x5eed);
+            
+            for ( auto b = 0; b < numBands; ++b )
+            {
+                bands[b].setSize(channels, size);
+                
+                for ( auto ch = 0; ch < channels; ++ch )
+                    for ( auto i = 0; i < size; ++i )
+                        bands[b].setSample(ch, i, 0.5f * (random.nextFloat() * 2.f - 1.f));
+                
+                compressors[b].prepare({ sampleRate, static_cast<juce::uint32>(size), static_cast<juce::uint32>(channels) });
+                compressors[b].setThreshold(-24.f);
+                compressors[b].setRatio(4.f);
+            }
+            
+            auto bandTask = [&](int b)
+            {
+                compressors[static_cast<size_t>(b)].process(bands[static_cast<size_t>(b)].getArrayOfWritePointers(), channels, size);
+            };
+            
+            auto numBlocks = numSamples / size;
+            
+            auto inlineRate = measure([&]
+            {
+                for ( auto block = 0; block < numBlocks; ++block )
+                    for ( auto b = 0; b < numBands; ++b )
+                        bandTask(b);
+            });
+            
+            auto poolRate = measure([&]
+            {
+                for ( auto block = 0; block < numBlocks; ++block )
+                    pool.run(numBands, bandTask);
+            });
+            
+            if ( crossoverPoint == 0 && poolRate > inlineRate )
+                crossoverPoint = size;
+            
+            std::cout << juce::String(channels) << " ch, " << juce::String(size).paddedLeft(' ', 4) << " samples   "
+                      << "inline " << juce::String(1.0e6 * size / inlineRate, 2) << " us   "
+                      << "pool " << juce::String(1.0e6 * size / poolRate, 2) << " us   "
+                      << "x" << juce::String(poolRate / inlineRate, 2) << std::endl;
+        }
+        
+        std::cout << "-> pool wins from " << (crossoverPoint > 0 ? juce::String(crossoverPoint * channels) + " samples * channels" : juce::String("never"))
+                  << std::endl << std::endl;
+    }
+}
+
+//==============================================================================
+// the whole plugin through processBlock, as a host would drive it. Every combination of
+// block size, sample rate, channel count and band state, one result per combination
+juce::var benchmarkProcessor()
+{
+    const int blockSizes[] = { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192 };
+    const double sampleRates[] = { 44100.0, 48000.0, 96000.0, 192000.0 };
+    const int channelCounts[] = { 1, 2, 6, 16 };
+    
+    enum class State { Active, Solo, Bypass, Automation, Silence };
+    const std::pair<State, const char*> states[] =
+    {
+        { State::Active,     "all active" },
+        { State::Solo,       "solo" },
+        { State::Bypass,     "bypass" },
+        { State::Automation, "automation storm" },
+        { State::Silence,    "silence" }
+    };
+    
+    constexpr double secondsPerRun = 0.5;
+    constexpr int processorRuns = 3;
+    
+    std::cout << std::endl << "processBlock, " << Params::numBands << " bands (ns per sample, best of " << processorRuns << ")" << std::endl << std::endl;
+    
+    juce::Array<juce::var> results;
+    
+    for ( auto channels : channelCounts )
+    {
+        auto layout = channels == 1 ? juce::AudioChannelSet::mono()
+                    : channels == 2 ? juce::AudioChannelSet::stereo()
+                    : channels == 6 ? juce::AudioChannelSet::create5point1()
+                    : juce::AudioChannelSet::discreteChannels(channels);
+        
+        for ( auto rate : sampleRates )
+        {
+            auto numFrames = static_cast<int>(rate * secondsPerRun);
+            
+            juce::AudioBuffer<float> source(channels, numFrames);
+            juce::Random random(0x5eed);
+            
+            for ( auto ch = 0; ch < channels; ++ch )
+                for ( auto i = 0; i < numFrames; ++i )
+                    source.setSample(ch, i, 0.5f * (random.nextFloat() * 2.f - 1.f));
+            
+            for ( auto size : blockSizes )
+            {
+                for ( const auto& [state, stateName] : states )
+                {
+                    auto processor = std::make_unique<MBCompTutorialAudioProcessor>();
+                    
+                    auto setParam = [&](const juce::String& name, float value)
+                    {
+                        auto* param = processor->apvts.getParameter(name);
+                        jassert(param != nullptr);
+                        param->setValueNotifyingHost(param->convertTo0to1(value));
+                    };
+                    
+                    // by label, an index written straight in would quietly pick something else
+                    // if the choice list ever changes
+                    auto setChoice = [&](const juce::String& name, const juce::String& choice)
+                    {
+                        auto* param = dynamic_cast<juce::AudioParameterChoice*>(processor->apvts.getParameter(name));
+                        jassert(param != nullptr);
+                        
+                        auto index = param->choices.indexOf(choice);
+                        jassert(index >= 0);
+                        param->setValueNotifyingHost(param->convertTo0to1(static_cast<float>(index)));
+                    };
+                    
+                    // every band compressing, so active and bypass differ by the whole compressor
+                    for ( size_t b = 0; b < Params::numBands; ++b )
+                    {
+                        setParam(Params::getBandParamName(Params::Threshold, b), -24.f);
+                        setChoice(Params::getBandParamName(Params::Ratio, b), juce::String(4.f, 1));
+                        setParam(Params::getBandParamName(Params::Bypass, b), state == State::Bypass ? 1.f : 0.f);
+                    }
+                    
+                    if ( state == State::Solo )
+                        setParam(Params::getBandParamName(Params::Solo, 0), 1.f);
+                    
+                    // continuous params only, a storm of lookahead or oversampling changes would
+                    // measure the latency updates rather than the processing
+                    std::vector<juce::AudioProcessorParameter*> automated;
+                    
+                    if ( state == State::Automation )
+                    {
+                        for ( size_t b = 0; b < Params::numBands; ++b )
+                            for ( auto param : { Params::Threshold, Params::Attack, Params::Release, Params::Knee } )
+                                automated.push_back(processor->apvts.getParameter(Params::getBandParamName(param, b)));
+                        
+                        for ( size_t i = 0; i < Params::numCrossovers; ++i )
+                            automated.push_back(processor->apvts.getParameter(Params::getCrossoverParamName(i)));
+                        
+                        automated.push_back(processor->apvts.getParameter(Params::getParams().at(Params::Gain_In)));
+                        automated.push_back(processor->apvts.getParameter(Params::getParams().at(Params::Gain_Out)));
+                    }
+                    
+                    // main bus only, the sidechain bus stays disabled
+                    auto buses = processor->getBusesLayout();
+                    buses.inputBuses.set(0, layout);
+                    buses.outputBuses.set(0, layout);
+                    
+                    if ( !processor->setBusesLayout(buses) )
+                    {
+                        // a layout this build doesn't take, not a failure of the benchmark
+                        continue;
+                    }
+                    
+                    // a host's order, without it the processor's sample rate is 0 and the tail
+                    // and silence sleep never get measured
+                    processor->setPlayConfigDetails(channels, channels, rate, size);
+                    processor->prepareToPlay(rate, size);
+                    
+                    juce::AudioBuffer<float> buffer(channels, size);
+                    juce::MidiBuffer midi;
+                    juce::Random automation(0x5eed);
+                    
+                    auto best = std::numeric_limits<double>::max();
+                    
+                    // one extra pass first to settle the caches, the filters and the envelopes
+                    for ( auto run = 0; run <= processorRuns; ++run )
+                    {
+                        auto seconds = 0.0;
+                        
+                        for ( auto start = 0; start + size <= numFrames; start += size )
+                        {
+                            // silence runs into the sleep mode once the settling pass has rung out
+                            if ( state == State::Silence )
+                                buffer.clear();
+                            else
+                                for ( auto ch = 0; ch < channels; ++ch )
+                                    buffer.copyFrom(ch, 0, source, ch, start, size);
+                            
+                            for ( auto* param : automated )
+                                param->setValueNotifyingHost(automation.nextFloat());
+                            
+                            auto begin = juce::Time::getHighResolutionTicks();
+                            processor->processBlock(buffer, midi);
+                            seconds += juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - begin);
+                        }
+                        
+                        if ( run > 0 )
+                            best = juce::jmin(best, seconds);
+                    }
+                    
+                    processor->releaseResources();
+                    
+                    auto framesProcessed = (numFrames / size) * size;
+                    auto nsPerSample = 1.0e9 * best / framesProcessed;
+                    
+                    auto* result = new juce::DynamicObject();
+                    result->setProperty("blockSize", size);
+                    result->setProperty("sampleRate", rate);
+                    result->setProperty("channels", channels);
+                    result->setProperty("state", stateName);
+                    result->setProperty("nsPerSample", nsPerSample);
+                    result->setProperty("nsPerChannelSample", nsPerSample / channels);
+                    result->setProperty("realtimeFactor", 1.0e9 / (nsPerSample * rate));
+                    results.add(juce::var(result));
+                    
+                    std::cout << juce::String(channels).paddedLeft(' ', 2) << " ch @ " << juce::String(rate / 1000.0, 1).paddedLeft(' ', 5) << " kHz, "
+                              << juce::String(size).paddedLeft(' ', 4) << " samples, " << juce::String(stateName).paddedRight(' ', 16)
+                              << juce::String(nsPerSample, 1).paddedLeft(' ', 8) << " ns/sample   "
+                              << "x" << juce::String(1.0e9 / (nsPerSample * rate), 1) << " realtime" << std::endl;
+                }
+            }
+        }
+    }
+    
+    return results;
+}
+
+//==============================================================================
+// blocks the editor didn't read in time have to add up rather than replace each other:
+// every block's samples counted exactly once, and the loudest peak still there
+int checkMeters()
+{
+    constexpr int numBlocks = 40;
+    constexpr int loudBlock = 13;
+    constexpr float loudPeak = 0.9f;
+    
+    auto processor = std::make_unique<MBCompTutorialAudioProcessor>();
+    processor->setMeteringActive(true);
+    processor->setPlayConfigDetails(numChannels, numChannels, sampleRate, blockSize);
+    processor->prepareToPlay(sampleRate, blockSize);
+    
+    juce::AudioBuffer<float> buffer(numChannels, blockSize);
+    juce::MidiBuffer midi;
+    juce::Random random(0x5eed);
+    
+    // quiet noise, so the chain never sleeps, with one loud sample in block loudAt
+    auto processBlocks = [&](int count, int loudAt)
+    {
+        for ( auto block = 0; block < count; ++block )
+        {
+            for ( auto ch = 0; ch < numChannels; ++ch )
+                for ( auto i = 0; i < blockSize; ++i )
+                    buffer.setSample(ch, i, 0.1f * (random.nextFloat() * 2.f - 1.f));
+            
+            if ( block == loudAt )
+                buffer.setSample(numChannels - 1, blockSize / 2, -loudPeak);
+            
+            processor->processBlock(buffer, midi);
+        }
+    };
+    
+    auto failures = 0;
+    
+    auto expect = [&](bool passed, const juce::String& what)
+    {
+        std::cout << (passed ? "ok     " : "FAILED ") << what << std::endl;
+        failures += passed ? 0 : 1;
+    };
+    
+    MBCompTutorialAudioProcessor::Meters meters;
+    
+    // none of them read until the end
+    processBlocks(numBlocks, loudBlock);
+    
+    expect(processor->readMeters(meters), "unread blocks are waiting");
+    expect(meters.input.numSamples == numBlocks * blockSize * numChannels,
+           "every unread block counted once: " + juce::String(meters.input.numSamples) + " samples");
+    expect(std::abs(meters.input.peak - loudPeak) < 1.0e-6f, "the loudest peak survived: " + juce::String(meters.input.peak));
+    expect(!processor->readMeters(meters), "nothing is read twice");
+    
+    // reads every one to three blocks
+    auto processed = 0, counted = 0;
+    
+    for ( auto round = 0; round < 30; ++round )
+    {
+        auto count = 1 + round % 3;
+        processBlocks(count, -1);
+        processed += count * blockSize * numChannels;
+        
+        if ( processor->readMeters(meters) )
+            counted += meters.input.numSamples;
+    }
+    
+    expect(counted == processed, "reads in between count every block once: " + juce::String(counted) + " of " + juce::String(processed) + " samples");
+    
+    processor->releaseResources();
+    
+    std::cout << std::endl << (failures == 0 ? "PASS" : "FAIL") << std::endl;
+    return failures;
+}
+
+void writeJson(const juce::File& file, const juce::var& processorResults, const juce::String& label)
+{
+    auto* root = new juce::DynamicObject();
+    root->setProperty("label", label);
+    root->setProperty("date", juce::Time::getCurrentTime().toISO8601(true));
+    root->setProperty("juce", juce::SystemStats::getJUCEVersion());
+    root->setProperty("os", juce::SystemStats::getOperatingSystemName());
+    root->setProperty("cpu", juce::SystemStats::getCpuModel());
+    root->setProperty("numCpus", juce::SystemStats::getNumCpus());
+   #if JUCE_DEBUG
+    root->setProperty("debugBuild", true);
+   #else
+    root->setProperty("debugBuild", false);
+   #endif
+    root->setProperty("numBands", static_cast<int>(Params::numBands));
+    root->setProperty("processBlock", processorResults);
+    
+    if ( !file.replaceWithText(juce::JSON::toString(juce::var(root))) )
+        std::cerr << "couldn't write " << file.getFullPathName() << std::endl;
+}
+
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // the processor's parameter tree wants a message manager, no window is ever opened
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    
+    juce::StringArray args(argv + 1, argc - 1);
+    
+    auto optionValue = [&](const juce::String& option)
+    {
+        auto index = args.indexOf(option);
+        return index >= 0 ? args[index + 1] : juce::String();
+    };
+    
+    if ( args.contains("--rt-check") )
+    {
+        auto seed = optionValue("--seed");
+        auto scenarios = optionValue("--scenarios");
+        
+        auto violations = RealtimeCheck::run(seed.isNotEmpty() ? seed.getLargeIntValue() : juce::Time::currentTimeMillis(),
+                                             scenarios.isNotEmpty() ? scenarios.getIntValue() : 40,
+                                             args.contains("--abort"));
+        
+        return violations == 0 ? 0 : (violations < 0 ? 2 : 1);
+    }
+    
+    if ( args.contains("--meter-check") )
+        return checkMeters() == 0 ? 0 : 1;
+    
+    if ( !args.contains("--processor") )
+    {
+        benchmarkCompressors();
+        benchmarkChannelCounts();
+        benchmarkCrossovers();
+        benchmarkBandDispatch();
+    }
+    
+    auto processorResults = benchmarkProcessor();
+    
+    auto jsonPath = optionValue("--json");
+    if ( jsonPath.isNotEmpty() )
+        writeJson(juce::File::getCurrentWorkingDirectory().getChildFile(jsonPath), processorResults, optionValue("--label"));
+    
+    return 0;
+}
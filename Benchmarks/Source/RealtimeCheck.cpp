@@ -0,0 +1,298 @@
+/*
+  ==============================================================================
+
+    RealtimeCheck.cpp
+    Created: 17 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "RealtimeCheck.h"
+#include "../../Source/PluginProcessor.h"
+
+#if JUCE_LINUX
+
+#include <cerrno>
+#include <dlfcn.h>
+#include <pthread.h>
+
+extern "C"
+{
+    void* __libc_malloc(size_t);
+    void* __libc_calloc(size_t, size_t);
+    void* __libc_realloc(void*, size_t);
+    void* __libc_memalign(size_t, size_t);
+    void __libc_free(void*);
+}
+
+namespace
+{
+
+// static TLS in the executable, reading it never allocates
+thread_local bool checking = false;
+
+std::atomic<int> allocations { 0 }, frees { 0 }, locks { 0 };
+bool abortOnFirst = false;
+
+void violation(std::atomic<int>& counter)
+{
+    if ( !checking )
+        return;
+    
+    counter.fetch_add(1, std::memory_order_relaxed);
+    
+    // leaves a core with the offending stack
+    if ( abortOnFirst )
+    {
+        checking = false;
+        std::abort();
+    }
+}
+
+// looked up without a function static, its guard would take the very lock being wrapped
+template<typename Fn>
+Fn lookUp(std::atomic<Fn>& real, const char* name)
+{
+    auto fn = real.load(std::memory_order_relaxed);
+    
+    if ( fn == nullptr )
+    {
+        fn = reinterpret_cast<Fn>(dlsym(RTLD_NEXT, name));
+        real.store(fn, std::memory_order_relaxed);
+    }
+    
+    return fn;
+}
+
+}
+
+extern "C"
+{
+
+void* malloc(size_t size)
+{
+    violation(allocations);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t num, size_t size)
+{
+    violation(allocations);
+    return __libc_calloc(num, size);
+}
+
+void* realloc(void* ptr, size_t size)
+{
+    violation(allocations);
+    return __libc_realloc(ptr, size);
+}
+
+void* memalign(size_t alignment, size_t size)
+{
+    violation(allocations);
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size)
+{
+    violation(allocations);
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** ptr, size_t alignment, size_t size)
+{
+    violation(allocations);
+    *ptr = __libc_memalign(alignment, size);
+    return *ptr != nullptr ? 0 : ENOMEM;
+}
+
+void free(void* ptr)
+{
+    if ( ptr != nullptr )
+        violation(frees);
+    
+    __libc_free(ptr);
+}
+
+int pthread_mutex_lock(pthread_mutex_t* mutex)
+{
+    static std::atomic<int (*)(pthread_mutex_t*)> real { nullptr };
+    violation(locks);
+    return lookUp(real, "pthread_mutex_lock")(mutex);
+}
+
+int pthread_rwlock_rdlock(pthread_rwlock_t* lock)
+{
+    static std::atomic<int (*)(pthread_rwlock_t*)> real { nullptr };
+    violation(locks);
+    return lookUp(real, "pthread_rwlock_rdlock")(lock);
+}
+
+int pthread_rwlock_wrlock(pthread_rwlock_t* lock)
+{
+    static std::atomic<int (*)(pthread_rwlock_t*)> real { nullptr };
+    violation(locks);
+    return lookUp(real, "pthread_rwlock_wrlock")(lock);
+}
+
+}
+
+namespace
+{
+
+juce::AudioChannelSet layoutFor(int numChannels)
+{
+    switch ( numChannels )
+    {
+        case 1:  return juce::AudioChannelSet::mono();
+        case 2:  return juce::AudioChannelSet::stereo();
+        case 6:  return juce::AudioChannelSet::create5point1();
+        default: return juce::AudioChannelSet::discreteChannels(numChannels);
+    }
+}
+
+void randomiseParams(juce::AudioProcessor& processor, juce::Random& random, int numChanges)
+{
+    const auto& params = processor.getParameters();
+    
+    for ( auto i = 0; i < numChanges; ++i )
+        params[random.nextInt(params.size())]->setValueNotifyingHost(random.nextFloat());
+}
+
+template<typename SampleType>
+int runScenario(MBCompTutorialAudioProcessor& processor, juce::Random& random, int maxBlock, int numBlocks)
+{
+    auto numChannels = processor.getTotalNumInputChannels();
+    
+    // longer than promised, hosts don't always stick to it
+    juce::AudioBuffer<SampleType> buffer(numChannels, 2 * maxBlock);
+    juce::MidiBuffer midi;
+    
+    juce::MemoryBlock savedState;
+    processor.getStateInformation(savedState);
+    
+    auto before = allocations.load() + frees.load() + locks.load();
+    
+    for ( auto block = 0; block < numBlocks; ++block )
+    {
+        if ( random.nextInt(4) == 0 )
+            randomiseParams(processor, random, 1 + random.nextInt(8));
+        
+        if ( random.nextInt(50) == 0 )
+        {
+            if ( random.nextBool() )
+                processor.getStateInformation(savedState);
+            else
+                processor.setStateInformation(savedState.getData(), static_cast<int>(savedState.getSize()));
+        }
+        
+        auto numSamples = 1 + random.nextInt(2 * maxBlock);
+        juce::AudioBuffer<SampleType> hostBlock(buffer.getArrayOfWritePointers(), numChannels, numSamples);
+        
+        for ( auto ch = 0; ch < numChannels; ++ch )
+            for ( auto i = 0; i < numSamples; ++i )
+                hostBlock.setSample(ch, i, static_cast<SampleType>(random.nextFloat() * 2.f - 1.f));
+        
+        checking = true;
+        processor.processBlock(hostBlock, midi);
+        checking = false;
+    }
+    
+    return allocations.load() + frees.load() + locks.load() - before;
+}
+
+}
+
+namespace RealtimeCheck
+{
+
+int run(juce::int64 seed, int numScenarios, bool abortOnViolation)
+{
+    abortOnFirst = abortOnViolation;
+    juce::Random random(seed);
+    
+    const int channelCounts[] = { 1, 2, 6, 16 };
+    const double sampleRates[] = { 44100.0, 48000.0, 96000.0, 192000.0 };
+    const int blockSizes[] = { 16, 64, 128, 512, 1024, 4096 };
+    constexpr int blocksPerScenario = 400;
+    
+    std::cout << "Realtime check, seed " << seed << ", " << numScenarios << " scenarios of " << blocksPerScenario << " blocks" << std::endl << std::endl;
+    
+    auto total = 0;
+    
+    for ( auto scenario = 0; scenario < numScenarios; ++scenario )
+    {
+        auto numChannels = channelCounts[random.nextInt(4)];
+        auto rate = sampleRates[random.nextInt(4)];
+        auto maxBlock = blockSizes[random.nextInt(6)];
+        auto isDouble = random.nextBool();
+        auto sidechain = random.nextInt(3);   // off, mono, same as main
+        
+        auto processor = std::make_unique<MBCompTutorialAudioProcessor>();
+        
+        auto buses = processor->getBusesLayout();
+        buses.inputBuses.set(0, layoutFor(numChannels));
+        buses.outputBuses.set(0, layoutFor(numChannels));
+        
+        if ( buses.inputBuses.size() > 1 )
+            buses.inputBuses.set(1, sidechain == 0 ? juce::AudioChannelSet::disabled()
+                                  : sidechain == 1 ? juce::AudioChannelSet::mono()
+                                  : layoutFor(numChannels));
+        
+        if ( !processor->setBusesLayout(buses) )
+        {
+            std::cout << "scenario " << scenario << ": layout rejected" << std::endl;
+            continue;
+        }
+        
+        randomiseParams(*processor, random, 16);
+        
+        // waking a sleeping band worker takes its event's lock, so keep the pool stopped
+        processor->apvts.getParameter(Params::getParams().at(Params::Parallel_Processing))->setValueNotifyingHost(0.0f);
+        
+        processor->setProcessingPrecision(isDouble ? juce::AudioProcessor::doublePrecision : juce::AudioProcessor::singlePrecision);
+        // what setPlayConfigDetails does for a host, but that also turns the sidechain bus
+        // off, and the layout is already set
+        processor->setRateAndBufferSizeDetails(rate, maxBlock);
+        processor->prepareToPlay(rate, maxBlock);
+        
+        allocations = 0;
+        frees = 0;
+        locks = 0;
+        
+        auto violations = isDouble ? runScenario<double>(*processor, random, maxBlock, blocksPerScenario)
+                                   : runScenario<float>(*processor, random, maxBlock, blocksPerScenario);
+        
+        processor->releaseResources();
+        total += violations;
+        
+        std::cout << "scenario " << juce::String(scenario).paddedLeft(' ', 2) << ": "
+                  << juce::String(numChannels).paddedLeft(' ', 2) << " ch, "
+                  << (sidechain == 0 ? "no sidechain, " : sidechain == 1 ? "mono sidechain, " : "sidechain, ")
+                  << juce::String(rate / 1000.0, 1) << " kHz, " << maxBlock << " samples, " << (isDouble ? "double" : "float") << "   "
+                  << (violations == 0 ? juce::String("ok")
+                                      : juce::String(allocations.load()) + " allocations, " + juce::String(frees.load()) + " frees, "
+                                        + juce::String(locks.load()) + " locks")
+                  << std::endl;
+    }
+    
+    std::cout << std::endl << (total == 0 ? "PASS" : "FAIL") << std::endl;
+    return total;
+}
+
+}
+
+#else
+
+namespace RealtimeCheck
+{
+
+int run(juce::int64, int, bool)
+{
+    std::cout << "the realtime check interposes glibc's allocator, it only runs on Linux" << std::endl;
+    return -1;
+}
+
+}
+
+#endif
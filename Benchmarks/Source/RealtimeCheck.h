@@ -0,0 +1,35 @@
+/*
+  ==============================================================================
+
+    RealtimeCheck.h
+    Created: 17 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/*
+    Fails if processBlock ever touches the heap or a lock.
+
+    On Linux the benchmarks executable interposes malloc/calloc/realloc/free, the
+    aligned allocators and pthread mutex/rwlock locking. Each call counts as a
+    violation only while the calling thread is inside processBlock.
+
+    Every scenario picks a random layout, sidechain, sample rate, host block size
+    and precision. It then runs blocks of random length, which may be longer than
+    prepareToPlay promised. Between blocks it makes random parameter changes and
+    now and then loads a saved state, both outside the checked region as a host's
+    message thread would. Parallel processing is off when prepareToPlay runs, so the
+    band workers never start: waking one takes a lock. The bands then all run on the
+    calling thread, which covers the same band paths.
+*/
+namespace RealtimeCheck
+{
+
+// number of violations, 0 is a pass - or -1 where the interposition isn't available
+int run(juce::int64 seed, int numScenarios, bool abortOnViolation);
+
+}
@@ -0,0 +1,313 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 16 Oct 2026
+
+    Offline renderer, runs audio files through the plugin without a host.
+
+    MBCompRender --preset <file> [--out <dir>] [--suffix <text>] [--block <samples>]
+                 [--jobs <n>] <input files...>
+
+    --preset <file>   state saved by getStateInformation (binary), or the same tree as xml
+    --out <dir>       where the rendered files go, next to each input by default
+    --suffix <text>   appended to each output name, "_mbcomp" by default
+    --block <samples> host block size, 8192 by default
+    --jobs <n>        files rendered at once, one processor per worker thread
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+
+namespace
+{
+
+struct Options
+{
+    juce::MemoryBlock preset;
+    juce::File outputDir;
+    juce::String suffix { "_mbcomp" };
+    int blockSize { 8192 };
+    int numJobs { 1 };
+    juce::Array<juce::File> inputs;
+};
+
+struct RenderResult
+{
+    juce::File input, output;
+    juce::String error;
+    double audioSeconds { 0.0 }, renderSeconds { 0.0 };
+};
+
+// the binary tree getStateInformation writes, or the same tree as xml so presets can be edited by hand
+bool loadPreset(const juce::File& file, juce::MemoryBlock& state)
+{
+    if ( !file.loadFileAsData(state) || state.getSize() == 0 )
+        return false;
+    
+    if ( juce::ValueTree::readFromData(state.getData(), state.getSize()).isValid() )
+        return true;
+    
+    if ( auto xml = juce::parseXML(file) )
+    {
+        auto tree = juce::ValueTree::fromXml(*xml);
+        if ( tree.isValid() )
+        {
+            state.reset();
+            juce::MemoryOutputStream stream(state, false);
+            tree.writeToStream(stream);
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+juce::AudioChannelSet layoutFor(int numChannels)
+{
+    switch ( numChannels )
+    {
+        case 1:  return juce::AudioChannelSet::mono();
+        case 2:  return juce::AudioChannelSet::stereo();
+        default: return juce::AudioChannelSet::discreteChannels(numChannels);
+    }
+}
+
+//==============================================================================
+// owns one processor for its whole life and renders whichever file is next in the queue
+struct RenderWorker : juce::Thread
+{
+    RenderWorker(const Options& o, juce::AudioFormatManager& f, std::atomic<int>& next, std::vector<RenderResult>& r)
+        : juce::Thread("Render Worker"), options(o), formats(f), nextInput(next), results(r)
+    {
+        // parameters and state are set up here on the message thread, the worker only processes
+        processor.setStateInformation(options.preset.getData(), static_cast<int>(options.preset.getSize()));
+        processor.setNonRealtime(true);
+    }
+    
+    ~RenderWorker() override
+    {
+        stopThread(-1);
+    }
+    
+    void run() override
+    {
+        for ( auto index = nextInput++; index < options.inputs.size() && !threadShouldExit(); index = nextInput++ )
+        {
+            auto& result = results[static_cast<size_t>(index)];
+            result.input = options.inputs[index];
+            result.error = render(result);
+        }
+    }
+    
+    juce::String render(RenderResult& result)
+    {
+        auto* format = formats.findFormatForFileExtension(result.input.getFileExtension());
+        if ( format == nullptr )
+            return "unknown format";
+        
+        // uncompressed files are read straight from the page cache, compressed ones (flac)
+        // can't be mapped and are decoded from a buffered stream
+        std::unique_ptr<juce::AudioFormatReader> reader;
+        
+        if ( auto* mapped = format->createMemoryMappedReader(result.input) )
+        {
+            if ( mapped->mapEntireFile() )
+                reader.reset(mapped);
+            else
+                delete mapped;
+        }
+        
+        if ( reader == nullptr )
+            reader.reset(formats.createReaderFor(result.input));
+        
+        if ( reader == nullptr )
+            return "couldn't read the file";
+        
+        auto numChannels = static_cast<int>(reader->numChannels);
+        auto length = reader->lengthInSamples;
+        
+        auto buses = processor.getBusesLayout();
+        buses.inputBuses.set(0, layoutFor(numChannels));
+        buses.outputBuses.set(0, layoutFor(numChannels));
+        
+        if ( !processor.setBusesLayout(buses) )
+            return juce::String(numChannels) + " channels aren't supported";
+        
+        auto dir = options.outputDir == juce::File() ? result.input.getParentDirectory() : options.outputDir;
+        result.output = dir.getChildFile(result.input.getFileNameWithoutExtension() + options.suffix + result.input.getFileExtension());
+        result.output.deleteFile();
+        
+        auto stream = result.output.createOutputStream();
+        if ( stream == nullptr )
+            return "couldn't create " + result.output.getFullPathName();
+        
+        // same format and resolution as the source, flac tops out at 24 bits
+        auto bits = static_cast<int>(reader->bitsPerSample);
+        auto possibleBits = format->getPossibleBitDepths();
+        if ( !possibleBits.contains(bits) )
+            bits = possibleBits.getLast();
+        
+        std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(stream.get(), reader->sampleRate, static_cast<unsigned int>(numChannels),
+                                                                                bits, reader->metadataValues, 0));
+        if ( writer == nullptr )
+            return "couldn't write " + result.output.getFullPathName();
+        
+        // the writer owns the stream now
+        stream.release();
+        
+        auto start = juce::Time::getHighResolutionTicks();
+        
+        // as a host would, so the processor's own sample rate is right when it works out its tail
+        processor.setPlayConfigDetails(numChannels, numChannels, reader->sampleRate, options.blockSize);
+        processor.prepareToPlay(reader->sampleRate, options.blockSize);
+        
+        // the first latency samples out are the plugin's delay, dropping them and running
+        // that many samples of silence at the end keeps the render aligned with the source
+        auto latency = static_cast<juce::int64>(processor.getLatencySamples());
+        
+        juce::AudioBuffer<float> buffer(numChannels, options.blockSize);
+        juce::MidiBuffer midi;
+        
+        for ( juce::int64 in = 0, out = -latency; out < length; )
+        {
+            auto num = static_cast<int>(juce::jmin(static_cast<juce::int64>(options.blockSize), length - out));
+            
+            // the last block is shorter, the host buffer is only ever as long as what's in it
+            juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), numChannels, num);
+            
+            // past the end the reader fills in silence
+            reader->read(&block, 0, num, in, true, true);
+            processor.processBlock(block, midi);
+            
+            auto skip = static_cast<int>(juce::jlimit(static_cast<juce::int64>(0), static_cast<juce::int64>(num), -out));
+            if ( skip < num && !writer->writeFromAudioSampleBuffer(block, skip, num - skip) )
+                return "write failed";
+            
+            in += num;
+            out += num;
+        }
+        
+        processor.releaseResources();
+        writer.reset();
+        
+        result.renderSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+        result.audioSeconds = static_cast<double>(length) / reader->sampleRate;
+        
+        return {};
+    }
+    
+    const Options& options;
+    juce::AudioFormatManager& formats;
+    std::atomic<int>& nextInput;
+    std::vector<RenderResult>& results;
+    
+    MBCompTutorialAudioProcessor processor;
+};
+
+bool parseOptions(const juce::StringArray& args, Options& options)
+{
+    for ( auto i = 0; i < args.size(); ++i )
+    {
+        auto arg = args[i];
+        auto hasValue = i + 1 < args.size();
+        
+        if ( arg == "--preset" && hasValue )
+        {
+            auto file = juce::File::getCurrentWorkingDirectory().getChildFile(args[++i]);
+            if ( !loadPreset(file, options.preset) )
+            {
+                std::cerr << "couldn't load the preset " << file.getFullPathName() << std::endl;
+                return false;
+            }
+        }
+        else if ( arg == "--out" && hasValue )
+            options.outputDir = juce::File::getCurrentWorkingDirectory().getChildFile(args[++i]);
+        else if ( arg == "--suffix" && hasValue )
+            options.suffix = args[++i];
+        else if ( arg == "--block" && hasValue )
+            options.blockSize = juce::jlimit(16, 65536, args[++i].getIntValue());
+        else if ( arg == "--jobs" && hasValue )
+            options.numJobs = juce::jmax(1, args[++i].getIntValue());
+        else if ( arg.startsWith("--") )
+        {
+            std::cerr << "unknown option " << arg << std::endl;
+            return false;
+        }
+        else
+            options.inputs.add(juce::File::getCurrentWorkingDirectory().getChildFile(arg));
+    }
+    
+    if ( options.preset.isEmpty() || options.inputs.isEmpty() )
+    {
+        std::cerr << "usage: MBCompRender --preset <file> [--out <dir>] [--suffix <text>] [--block <samples>] [--jobs <n>] <input files...>" << std::endl;
+        return false;
+    }
+    
+    if ( options.outputDir != juce::File() && !options.outputDir.createDirectory() )
+    {
+        std::cerr << "couldn't create " << options.outputDir.getFullPathName() << std::endl;
+        return false;
+    }
+    
+    return true;
+}
+
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // the processor's parameter tree wants a message manager, no window is ever opened
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    
+    Options options;
+    if ( !parseOptions(juce::StringArray(argv + 1, argc - 1), options) )
+        return 1;
+    
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+    
+    std::atomic<int> nextInput { 0 };
+    std::vector<RenderResult> results(static_cast<size_t>(options.inputs.size()));
+    
+    juce::OwnedArray<RenderWorker> workers;
+    for ( auto i = 0; i < juce::jmin(options.numJobs, options.inputs.size()); ++i )
+        workers.add(new RenderWorker(options, formats, nextInput, results));
+    
+    auto start = juce::Time::getHighResolutionTicks();
+    
+    for ( auto* worker : workers )
+        worker->startThread();
+    
+    for ( auto* worker : workers )
+        worker->waitForThreadToExit(-1);
+    
+    auto wallSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+    auto audioSeconds = 0.0;
+    auto failed = 0;
+    
+    for ( const auto& result : results )
+    {
+        if ( result.error.isNotEmpty() )
+        {
+            ++failed;
+            std::cerr << result.input.getFullPathName() << ": " << result.error << std::endl;
+            continue;
+        }
+        
+        audioSeconds += result.audioSeconds;
+        
+        std::cout << result.output.getFullPathName() << "   "
+                  << juce::String(result.audioSeconds, 1) << " s in " << juce::String(result.renderSeconds, 2) << " s, "
+                  << "x" << juce::String(result.audioSeconds / result.renderSeconds, 1) << " realtime" << std::endl;
+    }
+    
+    std::cout << std::endl << juce::String(results.size() - static_cast<size_t>(failed)) << " files, "
+              << juce::String(audioSeconds, 1) << " s of audio in " << juce::String(wallSeconds, 2) << " s with "
+              << workers.size() << " jobs, x" << juce::String(audioSeconds / wallSeconds, 1) << " realtime" << std::endl;
+    
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,529 @@
+/*
+  ==============================================================================
+
+    Analyzer.h
+    Created: 17 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "Rendering.h"
+
+/*
+    Turns the processor's input and output feeds into spectrum curves, on its own thread.
+
+    Every hopSize new samples of a feed it windows the latest fftSize of them, runs
+    the FFT and smooths the bin levels, then traces both curves for the display's
+    current size. The message thread only swaps the finished paths in and draws them.
+*/
+struct SpectrumAnalyzer : juce::Thread
+{
+    // 8192 points resolves about 5Hz at 44.1kHz, enough to see where a low crossover sits
+    static constexpr int fftOrder = 13;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int hopSize = fftSize / 8;
+    static constexpr int numBins = fftSize / 2 + 1;
+
+    static constexpr float minFreq = 20.f, maxFreq = 20000.f;
+    static constexpr float minDb = -90.f, maxDb = 0.f;
+
+    enum Feed
+    {
+        Input_Feed,
+        Output_Feed,
+        Num_Feeds
+    };
+
+    SpectrumAnalyzer(MBCompTutorialAudioProcessor& p) : juce::Thread("Spectrum Analyzer"), audioProcessor(p) {}
+
+    ~SpectrumAnalyzer() override
+    {
+        stopThread(1000);
+    }
+
+    // 0 - 1 across the display, log spaced between minFreq and maxFreq
+    static float proportionForFrequency(float freq) { return juce::mapFromLog10(juce::jlimit(minFreq, maxFreq, freq), minFreq, maxFreq); }
+    static float frequencyForProportion(float proportion) { return juce::mapToLog10(juce::jlimit(0.f, 1.f, proportion), minFreq, maxFreq); }
+
+    // message thread, the area the curves are traced for
+    void setSize(int newWidth, int newHeight)
+    {
+        width.store(newWidth);
+        height.store(newHeight);
+        notify();
+    }
+
+    // one feed's spectrum as traced for the display: the path to draw, and its height
+    // at every pixel column so the display can tell where it moved
+    struct Curve
+    {
+        juce::Path path;
+        std::vector<float> y;
+    };
+
+    using Curves = std::array<Curve, Num_Feeds>;
+
+    // message thread, swaps the latest curves into dest - false if nothing was traced
+    // since the last call. The input curve is closed along the bottom for filling
+    bool takeCurves(Curves& dest)
+    {
+        if ( !newPaths.load() )
+            return false;
+
+        const juce::ScopedLock lock(pathLock);
+
+        for ( size_t f = 0; f < Num_Feeds; ++f )
+        {
+            dest[f].path.swapWithPath(shared[f].path);
+            dest[f].y.swap(shared[f].y);
+        }
+
+        newPaths.store(false);
+
+        return true;
+    }
+
+    void run() override
+    {
+        // whatever the feeds hold is from before the editor opened
+        for ( auto& feed : feeds )
+        {
+            feed.fifo.discard();
+            std::fill(feed.history.begin(), feed.history.end(), 0.f);
+            std::fill(feed.levels.begin(), feed.levels.end(), minDb);
+        }
+
+        while ( !threadShouldExit() )
+        {
+            auto analysed = false;
+
+            for ( auto& feed : feeds )
+            {
+                while ( feed.fifo.getNumReady() >= hopSize && !threadShouldExit() )
+                {
+                    analyse(feed);
+                    analysed = true;
+                }
+            }
+
+            if ( analysed || width.load() != tracedWidth || height.load() != tracedHeight )
+                trace();
+
+            wait(10);
+        }
+    }
+
+private:
+    struct FeedState
+    {
+        FeedState(AnalyzerFifo& f) : fifo(f) {}
+
+        AnalyzerFifo& fifo;
+
+        // the last fftSize samples, oldest first
+        std::vector<float> history = std::vector<float>(fftSize, 0.f);
+
+        // smoothed dB per bin
+        std::vector<float> levels = std::vector<float>(numBins, minDb);
+    };
+
+    // bins that land on one pixel column: the loudest of [first, last], or where
+    // there's less than a bin per pixel, first and first + 1 interpolated by fraction
+    struct Column
+    {
+        int first { 0 }, last { 0 };
+        float fraction { 0.f };
+    };
+
+    void analyse(FeedState& feed)
+    {
+        // slide the window along by one hop
+        std::copy(feed.history.begin() + hopSize, feed.history.end(), feed.history.begin());
+        feed.fifo.pull(feed.history.data() + fftSize - hopSize, hopSize);
+
+        std::copy(feed.history.begin(), feed.history.end(), fftData.begin());
+        window.multiplyWithWindowingTable(fftData.data(), fftSize);
+        fft.performFrequencyOnlyForwardTransform(fftData.data());
+
+        updateBallistics();
+
+        // the window is normalised to unity gain, a full scale sine reads 0dB
+        for ( size_t bin = 0; bin < numBins; ++bin )
+        {
+            auto db = juce::Decibels::gainToDecibels(fftData[bin] * (2.f / fftSize), minDb);
+            auto& level = feed.levels[bin];
+
+            level += (db - level) * (db > level ? attackCoeff : releaseCoeff);
+        }
+    }
+
+    // per hop smoothing from time constants, so the curve moves the same at any sample rate
+    void updateBallistics()
+    {
+        auto sampleRate = audioProcessor.getSampleRate();
+        if ( sampleRate <= 0.0 || sampleRate == ballisticsRate )
+            return;
+
+        ballisticsRate = sampleRate;
+
+        auto hopSeconds = hopSize / sampleRate;
+        attackCoeff = static_cast<float>(1.0 - std::exp(-hopSeconds / 0.02));
+        releaseCoeff = static_cast<float>(1.0 - std::exp(-hopSeconds / 0.3));
+    }
+
+    void buildColumns(int w, double sampleRate)
+    {
+        columns.resize(static_cast<size_t>(w) + 1);
+
+        auto binsPerHz = static_cast<float>(fftSize / sampleRate);
+
+        for ( auto x = 0; x <= w; ++x )
+        {
+            auto lo = frequencyForProportion(static_cast<float>(x) / w) * binsPerHz;
+            auto hi = frequencyForProportion(static_cast<float>(x + 1) / w) * binsPerHz;
+
+            auto& column = columns[static_cast<size_t>(x)];
+            column.first = juce::jmin(static_cast<int>(lo), numBins - 1);
+
+            if ( hi - lo < 1.f )
+            {
+                column.last = juce::jmin(column.first + 1, numBins - 1);
+                column.fraction = lo - static_cast<float>(column.first);
+            }
+            else
+            {
+                column.last = juce::jmin(static_cast<int>(hi), numBins - 1);
+                column.fraction = -1.f;
+            }
+        }
+    }
+
+    float getColumnLevel(const std::vector<float>& levels, const Column& column) const
+    {
+        if ( column.fraction >= 0.f )
+            return juce::jmap(column.fraction, levels[static_cast<size_t>(column.first)], levels[static_cast<size_t>(column.last)]);
+
+        return *std::max_element(levels.begin() + column.first, levels.begin() + column.last + 1);
+    }
+
+    void trace()
+    {
+        tracedWidth = width.load();
+        tracedHeight = height.load();
+
+        auto sampleRate = audioProcessor.getSampleRate();
+
+        if ( tracedWidth <= 0 || tracedHeight <= 0 || sampleRate <= 0.0 )
+            return;
+
+        if ( static_cast<int>(columns.size()) != tracedWidth + 1 || sampleRate != columnsRate )
+        {
+            columnsRate = sampleRate;
+            buildColumns(tracedWidth, sampleRate);
+        }
+
+        auto bottom = static_cast<float>(tracedHeight);
+
+        for ( size_t f = 0; f < Num_Feeds; ++f )
+        {
+            auto& path = traced[f].path;
+            path.clear();
+            path.preallocateSpace(3 * (tracedWidth + 4));
+
+            auto& heights = traced[f].y;
+            heights.resize(static_cast<size_t>(tracedWidth) + 1);
+
+            for ( auto x = 0; x <= tracedWidth; ++x )
+            {
+                auto level = getColumnLevel(feeds[f].levels, columns[static_cast<size_t>(x)]);
+                auto y = juce::jmap(juce::jlimit(minDb, maxDb, level), minDb, maxDb, bottom, 0.f);
+                heights[static_cast<size_t>(x)] = y;
+
+                if ( x == 0 )
+                    path.startNewSubPath(0.f, y);
+                else
+                    path.lineTo(static_cast<float>(x), y);
+            }
+
+            if ( f == Input_Feed )
+            {
+                path.lineTo(static_cast<float>(tracedWidth), bottom);
+                path.lineTo(0.f, bottom);
+                path.closeSubPath();
+            }
+        }
+
+        {
+            const juce::ScopedLock lock(pathLock);
+
+            for ( size_t f = 0; f < Num_Feeds; ++f )
+            {
+                shared[f].path.swapWithPath(traced[f].path);
+                shared[f].y.swap(traced[f].y);
+            }
+        }
+
+        newPaths.store(true);
+    }
+
+    MBCompTutorialAudioProcessor& audioProcessor;
+
+    // analysis thread only
+    std::array<FeedState, Num_Feeds> feeds { FeedState(audioProcessor.inputSpectrum), FeedState(audioProcessor.outputSpectrum) };
+
+    juce::dsp::FFT fft { fftOrder };
+    juce::dsp::WindowingFunction<float> window { static_cast<size_t>(fftSize), juce::dsp::WindowingFunction<float>::hann, true };
+    std::vector<float> fftData = std::vector<float>(2 * fftSize, 0.f);
+
+    double ballisticsRate { 0.0 }, columnsRate { 0.0 };
+    float attackCoeff { 1.f }, releaseCoeff { 1.f };
+
+    std::vector<Column> columns;
+    int tracedWidth { 0 }, tracedHeight { 0 };
+    Curves traced;
+
+    std::atomic<int> width { 0 }, height { 0 };
+
+    juce::CriticalSection pathLock;
+    Curves shared;
+    std::atomic<bool> newPaths { false };
+};
+
+// input and output spectrum, with a handle on every crossover that can be dragged along it
+struct SpectrumDisplay : juce::Component
+{
+    SpectrumDisplay(MBCompTutorialAudioProcessor& p) : analyzer(p)
+    {
+        for ( size_t i = 0; i < Params::numCrossovers; ++i )
+        {
+            auto* param = p.apvts.getParameter(Params::getCrossoverParamName(i));
+            jassert(param != nullptr);
+
+            crossoverParams[i] = param;
+            crossoverAttachments[i] = std::make_unique<juce::ParameterAttachment>(*param, [this, i](float freq)
+            {
+                crossoverFreqs[i] = freq;
+                repaint();
+            });
+
+            crossoverAttachments[i]->sendInitialUpdate();
+        }
+
+        setOpaque(true);
+
+       #if JUCE_MAJOR_VERSION >= 7
+        analyzer.startThread(juce::Thread::Priority::low);
+       #else
+        analyzer.startThread(3);
+       #endif
+    }
+
+    ~SpectrumDisplay() override
+    {
+        analyzer.stopThread(1000);
+    }
+
+    // message thread, the editor calls this on every meter refresh
+    void refresh()
+    {
+        if ( !analyzer.takeCurves(incoming) )
+            return;
+
+        repaintChanges();
+        std::swap(curves, incoming);
+    }
+
+    void paint(juce::Graphics& g) override
+    {
+        FrameBudget::Scope cost;
+        auto bounds = getLocalBounds().toFloat();
+
+        background.draw(g, getLocalBounds(), [this](juce::Graphics& bg, juce::Rectangle<int> area)
+        {
+            bg.setColour(juce::Colour(22u, 27u, 34u));
+            bg.fillRect(area);
+
+            // grid every 12dB and at 1-2-5 frequencies
+            bg.setColour(juce::Colour(48u, 54u, 61u));
+
+            for ( auto db = SpectrumAnalyzer::maxDb - 12.f; db > SpectrumAnalyzer::minDb; db -= 12.f )
+                bg.drawHorizontalLine(juce::roundToInt(yForDb(db)), 0.f, static_cast<float>(area.getRight()));
+
+            for ( auto freq : { 50.f, 100.f, 200.f, 500.f, 1000.f, 2000.f, 5000.f, 10000.f } )
+                bg.drawVerticalLine(juce::roundToInt(xForFrequency(freq)), 0.f, static_cast<float>(area.getBottom()));
+        });
+
+        g.setColour(juce::Colour(139u, 148u, 158u).withAlpha(0.35f));
+        g.fillPath(curves[SpectrumAnalyzer::Input_Feed].path);
+
+        g.setColour(juce::Colour(88u, 166u, 255u));
+        g.strokePath(curves[SpectrumAnalyzer::Output_Feed].path, juce::PathStrokeType(1.5f));
+
+        g.setFont(11.f);
+
+        for ( size_t i = 0; i < Params::numCrossovers; ++i )
+        {
+            auto x = xForFrequency(crossoverFreqs[i]);
+            auto active = static_cast<int>(i) == draggedHandle || static_cast<int>(i) == hoveredHandle;
+
+            g.setColour(juce::Colour(210u, 153u, 34u).withAlpha(active ? 1.f : 0.7f));
+            g.fillRect(juce::Rectangle<float>(x - 1.f, bounds.getY(), 2.f, bounds.getHeight()));
+
+            auto label = crossoverFreqs[i] < 1000.f ? juce::String(juce::roundToInt(crossoverFreqs[i])) + " Hz"
+                                                    : juce::String(crossoverFreqs[i] / 1000.f, 2) + " kHz";
+
+            // labels go on whichever side of the handle has room
+            auto labelArea = juce::Rectangle<float>(x + 4.f, bounds.getY() + 2.f, 60.f, 14.f);
+            if ( labelArea.getRight() > bounds.getRight() )
+                labelArea = labelArea.withX(x - 64.f);
+
+            g.drawText(label, labelArea, labelArea.getX() > x ? juce::Justification::centredLeft : juce::Justification::centredRight);
+        }
+    }
+
+    void resized() override
+    {
+        analyzer.setSize(getWidth(), getHeight());
+    }
+
+    void mouseMove(const juce::MouseEvent& e) override
+    {
+        setHoveredHandle(getHandleAt(e.position.x));
+    }
+
+    void mouseExit(const juce::MouseEvent&) override
+    {
+        setHoveredHandle(-1);
+    }
+
+    void mouseDown(const juce::MouseEvent& e) override
+    {
+        draggedHandle = getHandleAt(e.position.x);
+
+        if ( draggedHandle >= 0 )
+            crossoverAttachments[static_cast<size_t>(draggedHandle)]->beginGesture();
+    }
+
+    void mouseDrag(const juce::MouseEvent& e) override
+    {
+        if ( draggedHandle < 0 )
+            return;
+
+        auto i = static_cast<size_t>(draggedHandle);
+        auto freq = SpectrumAnalyzer::frequencyForProportion(e.position.x / juce::jmax(1.f, static_cast<float>(getWidth())));
+
+        // each crossover's own range keeps it between its neighbours
+        crossoverAttachments[i]->setValueAsPartOfGesture(crossoverParams[i]->getNormalisableRange().snapToLegalValue(freq));
+    }
+
+    void mouseUp(const juce::MouseEvent& e) override
+    {
+        if ( draggedHandle >= 0 )
+            crossoverAttachments[static_cast<size_t>(draggedHandle)]->endGesture();
+
+        draggedHandle = -1;
+        setHoveredHandle(getHandleAt(e.position.x));
+    }
+
+private:
+    float xForFrequency(float freq) const { return SpectrumAnalyzer::proportionForFrequency(freq) * static_cast<float>(getWidth()); }
+
+    float yForDb(float db) const { return juce::jmap(db, SpectrumAnalyzer::minDb, SpectrumAnalyzer::maxDb, static_cast<float>(getHeight()), 0.f); }
+
+    // the closest handle within grabDistance of x, -1 for none
+    int getHandleAt(float x) const
+    {
+        static constexpr float grabDistance = 6.f;
+
+        auto closest = -1;
+        auto closestDistance = grabDistance;
+
+        for ( size_t i = 0; i < Params::numCrossovers; ++i )
+        {
+            auto distance = std::abs(xForFrequency(crossoverFreqs[i]) - x);
+
+            if ( distance <= closestDistance )
+            {
+                closest = static_cast<int>(i);
+                closestDistance = distance;
+            }
+        }
+
+        return closest;
+    }
+
+    // only where a curve moved between curves and incoming, a strip of columns at a time.
+    // The line between two columns changed if either end did, and everything it could
+    // have covered is between the old and new heights of both ends - the input's fill
+    // below that stays as it was. Steady material leaves most of the display alone
+    void repaintChanges()
+    {
+        static constexpr size_t stripWidth = 16;
+
+        auto numColumns = incoming[0].y.size();
+
+        for ( size_t f = 0; f < SpectrumAnalyzer::Num_Feeds; ++f )
+        {
+            if ( curves[f].y.size() != numColumns || incoming[f].y.size() != numColumns )
+            {
+                repaint();
+                return;
+            }
+        }
+
+        for ( size_t x0 = 0; x0 + 1 < numColumns; x0 += stripWidth )
+        {
+            auto x1 = juce::jmin(x0 + stripWidth, numColumns - 1);
+            auto top = std::numeric_limits<float>::max();
+            auto bottom = std::numeric_limits<float>::lowest();
+
+            for ( size_t f = 0; f < SpectrumAnalyzer::Num_Feeds; ++f )
+            {
+                const auto& before = curves[f].y;
+                const auto& after = incoming[f].y;
+
+                for ( auto x = x0; x < x1; ++x )
+                {
+                    if ( before[x] == after[x] && before[x + 1] == after[x + 1] )
+                        continue;
+
+                    top = juce::jmin(top, juce::jmin(before[x], before[x + 1], after[x], after[x + 1]));
+                    bottom = juce::jmax(bottom, juce::jmax(before[x], before[x + 1], after[x], after[x + 1]));
+                }
+            }
+
+            // room for the stroke and antialiasing around the line
+            if ( top <= bottom )
+                repaint(juce::Rectangle<float>(static_cast<float>(x0), top, static_cast<float>(x1 - x0), bottom - top).expanded(2.f).getSmallestIntegerContainer());
+        }
+    }
+
+    void setHoveredHandle(int handle)
+    {
+        if ( handle == hoveredHandle )
+            return;
+
+        hoveredHandle = handle;
+        setMouseCursor(handle >= 0 ? juce::MouseCursor::LeftRightResizeCursor : juce::MouseCursor::NormalCursor);
+        repaint();
+    }
+
+    SpectrumAnalyzer analyzer;
+
+    // what's on screen, and the latest trace being compared with it
+    SpectrumAnalyzer::Curves curves, incoming;
+
+    // background and grid
+    CachedBackground background;
+
+    // lowest crossover first
+    std::array<juce::RangedAudioParameter*, Params::numCrossovers> crossoverParams {};
+    std::array<std::unique_ptr<juce::ParameterAttachment>, Params::numCrossovers> crossoverAttachments;
+    std::array<float, Params::numCrossovers> crossoverFreqs {};
+
+    int hoveredHandle { -1 }, draggedHandle { -1 };
+};
@@ -12,6 +12,8 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "Meter.h"
+#include "Rendering.h"
 
 struct Band : juce::Component
 {
@@ -20,19 +22,25 @@ struct Band : juce::Component
     juce::Label bandLabel;
     juce::ToggleButton bypassButton{ "X" }, muteButton{ "M" }, soloButton{ "S" };
     
+    // band level after compression, and its gain reduction - fed by the editor
+    LevelMeter levelMeter;
+    GainReductionMeter gainReductionMeter;
+    
     using sliderAttachment = juce::AudioProcessorValueTreeState::SliderAttachment;
     sliderAttachment thresholdAttachment, attackAttachment, releaseAttachment;
     
     using buttonAttachment = juce::AudioProcessorValueTreeState::ButtonAttachment;
     buttonAttachment bypassAttachment, muteAttachment, soloAttachment;
     
-    Band(MBCompTutorialAudioProcessor& p, const juce::String& bandName) :
-        thresholdAttachment(p.apvts, ("Threshold " + bandName + " Band"), thresholdRotary),
-        attackAttachment(p.apvts, ("Attack " + bandName + " Band"), attackRotary),
-        releaseAttachment(p.apvts, ("Release " + bandName + " Band"), releaseRotary),
-        bypassAttachment(p.apvts, ("Bypass " + bandName + " Band"), bypassButton),
-        muteAttachment(p.apvts, ("Mute " + bandName + " Band"), muteButton),
-        soloAttachment(p.apvts, ("Solo " + bandName + " Band"), soloButton)
+    CachedBackground background;
+    
+    Band(MBCompTutorialAudioProcessor& p, size_t band) :
+        thresholdAttachment(p.apvts, Params::getBandParamName(Params::Threshold, band), thresholdRotary),
+        attackAttachment(p.apvts, Params::getBandParamName(Params::Attack, band), attackRotary),
+        releaseAttachment(p.apvts, Params::getBandParamName(Params::Release, band), releaseRotary),
+        bypassAttachment(p.apvts, Params::getBandParamName(Params::Bypass, band), bypassButton),
+        muteAttachment(p.apvts, Params::getBandParamName(Params::Mute, band), muteButton),
+        soloAttachment(p.apvts, Params::getBandParamName(Params::Solo, band), soloButton)
     {
         addRotary(thresholdRotary, thresholdLabel, "Threshold");
         addRotary(attackRotary, attackLabel, "Attack");
@@ -42,24 +50,20 @@ struct Band : juce::Component
         addAndMakeVisible(muteButton);
         addAndMakeVisible(soloButton);
         
+        addAndMakeVisible(levelMeter);
+        addAndMakeVisible(gainReductionMeter);
+        
         addAndMakeVisible(bandLabel);
-        bandLabel.setText(bandName, juce::dontSendNotification);
+        bandLabel.setText(Params::getBandName(band), juce::dontSendNotification);
         bandLabel.setJustificationType(juce::Justification::centred);
+        
+        // the cached panel covers every pixel, the editor never paints behind a band
+        setOpaque(true);
     }
     
     void paint(juce::Graphics& g) override
     {
-        auto bounds = getLocalBounds();
-        
-        auto grey = juce::Colour(48u, 54u, 61u);
-        auto navy = juce::Colour(13u, 17u, 23u);
-        
-        g.setColour(grey); // grey for border
-        g.fillAll();
-        
-        bounds.reduce(3, 2);
-        g.setColour(navy); // navy for fill
-        g.fillRoundedRectangle(bounds.toFloat(), 3);
+        background.draw(g, getLocalBounds(), drawPanelBackground);
     }
     
     void resized() override
@@ -67,6 +71,10 @@ struct Band : juce::Component
         auto bounds = getLocalBounds();
         auto toggleContainer = bounds.removeFromRight(50);
         
+        auto meterStrip = bounds.removeFromRight(30).reduced(3, 12);
+        levelMeter.setBounds(meterStrip.removeFromLeft(meterStrip.getWidth() / 2).withTrimmedRight(1));
+        gainReductionMeter.setBounds(meterStrip.withTrimmedLeft(1));
+        
         using Track = juce::Grid::TrackInfo;
         using Fr = juce::Grid::Fr;
         
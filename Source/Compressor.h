@@ -0,0 +1,641 @@
+/*
+  ==============================================================================
+
+    Compressor.h
+    Created: 16 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/*
+    Feed-forward compressor used by CompressorBand in place of juce::dsp::Compressor.
+
+    - ballistics use the same attack/release constants as juce::dsp::BallisticsFilter,
+      with the attack/release pick done as a select instead of a branch
+    - the gain computer works in log2 units through polynomial log2/exp2 approximations
+      (< 0.002 dB error) instead of per sample std::log/std::pow
+    - quadratic soft knee, peak or RMS detection
+    - if neither the envelope nor the block's peak can reach the knee, the gain is
+      exactly 1, so only the envelope is advanced
+    - optional lookahead: the audio goes through a delay of `latency` samples while the
+      detector only sees `latency - lookahead`, so gain reduction starts ahead of the
+      transient. The owner sets the latency of every band so they stay aligned.
+    - optional external key per channel, detected instead of the channel itself
+
+    Channels are assigned to link groups (by default every channel is its own group).
+    Each group has one detector, fed by the loudest of its channels or by their average
+    (Link::Sum), and its one gain curve goes to all of them. Groups are packed side by
+    side into the lanes of a juce::dsp::SIMDRegister, interleaved sample by sample, so
+    the envelope and gain computer run once per batch of lanes. The few float bit tricks
+    log2/exp2 need that SIMDRegister doesn't offer are done with the matching native
+    intrinsics.
+
+    SampleType is the audio's: float, or double for hosts that process in double
+    precision. The delays and the gain multiply run in SampleType, the detector and
+    gain computer always in float - gains accurate to 0.002 dB don't need more.
+*/
+
+// what doesn't depend on the sample type, shared by Compressor<float> and Compressor<double>
+struct CompressorBase
+{
+    enum class Detector
+    {
+        Peak,
+        RMS
+    };
+
+    // how the channels of a link group make up its one sidechain
+    enum class Link
+    {
+        Max,    // loudest channel, a hit on one channel ducks the whole group by its full amount
+        Sum     // channels averaged, so a signal on one channel alone reads lower than on all of them
+    };
+
+    static constexpr float maxLookaheadMs = 10.f;
+
+    // +24 dBFS, a full scale signal with the input gain all the way up
+    static constexpr float tailStartLevel = 16.f;
+
+    // lookahead plus room to line up with bands that have more oversampling latency
+    static constexpr float maxLatencyMs = 2.f * maxLookaheadMs;
+};
+
+template<typename SampleType>
+struct Compressor : CompressorBase
+{
+    using Vec = juce::dsp::SIMDRegister<float>;
+    static constexpr int lanes = static_cast<int>(Vec::SIZE);
+
+    // spec is the highest rate and largest block the compressor will run at,
+    // setSampleRate() can move down from there without allocating
+    void prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        sampleRate = preparedRate = spec.sampleRate;
+
+        auto numChannels = static_cast<int>(spec.numChannels);
+        numBatches = (numChannels + lanes - 1) / lanes;
+
+        channelGroups.resize(spec.numChannels);
+        for ( auto ch = 0; ch < numChannels; ++ch )
+            channelGroups[static_cast<size_t>(ch)] = ch;
+
+        numGroups = numChannels;
+
+        groupWeights.allocate(numBatches * lanes);
+        std::fill_n(groupWeights.get(), numBatches * lanes, 1.f);
+
+        envelopes.allocate(numBatches * lanes);
+        sidechain.allocate(numBatches * chunkSize * lanes);
+        gains.allocate(numBatches * chunkSize * lanes);
+        batchIsUnity.assign(static_cast<size_t>(numBatches), 1);
+
+        detectorIns.resize(spec.numChannels);
+        audioIns.resize(spec.numChannels);
+        outs.resize(spec.numChannels);
+
+        // room for the longest delay plus one chunk, since run() writes a chunk
+        // before reading any of it. Power of 2 so wrapping is a mask
+        maxDelay = static_cast<int>(std::ceil(maxLatencyMs * 0.001 * sampleRate));
+        ringSize = juce::nextPowerOfTwo(maxDelay + chunkSize);
+
+        // every sample is stored twice, ringSize apart, so any window of up to ringSize
+        // samples can be read as one contiguous run without wrapping
+        rings.resize(spec.numChannels);
+        keyRings.resize(spec.numChannels);
+        for ( auto* delays : { &rings, &keyRings } )
+            for ( auto& ring : *delays )
+                ring.assign(static_cast<size_t>(2 * ringSize), 0.f);
+
+        reset();
+        update();
+    }
+
+    void reset()
+    {
+        std::fill_n(envelopes.get(), numBatches * lanes, 0.f);
+        deepestReduction = 0.f;
+
+        clearDelays();
+
+        writePos = 0;
+    }
+
+    void setSampleRate(double newSampleRate)
+    {
+        jassert(newSampleRate <= preparedRate);
+        sampleRate = newSampleRate;
+        update();
+    }
+
+    void setThreshold(float newThresholdDb) { thresholdDb = newThresholdDb; update(); }
+    void setRatio(float newRatio)           { jassert(newRatio >= 1.f); ratio = newRatio; update(); }
+    void setAttack(float newAttackMs)       { attackMs = newAttackMs; update(); }
+    void setRelease(float newReleaseMs)     { releaseMs = newReleaseMs; update(); }
+    void setKnee(float newKneeDb)           { kneeDb = newKneeDb; update(); }
+    void setDetector(Detector newDetector)  { detector = newDetector; update(); }
+    void setLookahead(float newLookaheadMs) { lookaheadMs = newLookaheadMs; update(); }
+    void setLink(Link newLink)              { link = newLink; }
+
+    // how long the envelope takes to release from tailStartLevel down to the knee once the
+    // input stops - from then on the gain is exactly 1 again
+    double getReleaseSeconds() const
+    {
+        if ( releaseCte <= 0.f || kneeStartLevel >= tailStartLevel )
+            return 0.0;
+
+        // the envelope shrinks by releaseCte every sample, an RMS envelope is power
+        // so it has twice as far to fall in log terms
+        auto distance = std::log(tailStartLevel / kneeStartLevel) * (detector == Detector::RMS ? 2.0 : 1.0);
+        return distance / -std::log(static_cast<double>(releaseCte)) / sampleRate;
+    }
+
+    // group index per channel, channels that share a group share one detector.
+    // Copied into storage sized by prepare(), so safe on the audio thread
+    void setChannelGroups(const std::vector<int>& groupOfChannel)
+    {
+        jassert(groupOfChannel.size() == channelGroups.size());
+
+        numGroups = 0;
+        for ( size_t ch = 0; ch < channelGroups.size() && ch < groupOfChannel.size(); ++ch )
+        {
+            jassert(groupOfChannel[ch] >= 0 && groupOfChannel[ch] < static_cast<int>(channelGroups.size()));
+
+            channelGroups[ch] = groupOfChannel[ch];
+            numGroups = juce::jmax(numGroups, channelGroups[ch] + 1);
+        }
+
+        // 1 / channels in the group, scales a Link::Sum sidechain back to a channel's level
+        std::fill_n(groupWeights.get(), numBatches * lanes, 0.f);
+
+        for ( auto group : channelGroups )
+            groupWeights.get()[group] += 1.f;
+
+        for ( auto i = 0; i < numBatches * lanes; ++i )
+            groupWeights.get()[i] = groupWeights.get()[i] > 0.f ? 1.f / groupWeights.get()[i] : 1.f;
+    }
+
+    int getLookaheadSamples() const { return lookaheadSamples; }
+
+    // deepest gain reduction applied since the last call, in dB (0 = none). For meters, audio thread only
+    float takeGainReduction()
+    {
+        auto reductionDb = -deepestReduction * 6.0206f;
+        deepestReduction = 0.f;
+        return reductionDb;
+    }
+
+    // delay of the audio path, must be >= this band's lookahead. Only moves the
+    // read positions, the ring buffers were sized for the maximum in prepare()
+    void setLatency(int newLatency)
+    {
+        jassert(newLatency >= lookaheadSamples && newLatency <= maxDelay);
+        newLatency = juce::jlimit(lookaheadSamples, maxDelay, newLatency);
+
+        // the ring isn't written while there's no delay, drop whatever is left in it
+        if ( latency == 0 && newLatency > 0 )
+            clearDelays();
+
+        latency = newLatency;
+    }
+
+    // keys, if not null, holds one external sidechain per channel for the detector to
+    // listen to instead of the channel itself. It goes through the same lookahead delay
+    void process(SampleType* const* channels, const SampleType* const* keys, int numChannels, int numSamples)
+    {
+        run<true>(channels, keys, numChannels, numSamples);
+    }
+
+    void process(SampleType* const* channels, int numChannels, int numSamples)
+    {
+        run<true>(channels, nullptr, numChannels, numSamples);
+    }
+
+    // advances the envelope and the lookahead delay without applying any gain, keeps
+    // the detector current for bands that are skipped (muted, bypassed) so they come
+    // back without a jump, and bypassed bands stay time aligned with the others
+    void track(SampleType* const* channels, const SampleType* const* keys, int numChannels, int numSamples)
+    {
+        run<false>(channels, keys, numChannels, numSamples);
+    }
+
+    void track(SampleType* const* channels, int numChannels, int numSamples)
+    {
+        run<false>(channels, nullptr, numChannels, numSamples);
+    }
+
+    // scalar versions of the approximations the gain computer runs on each lane
+    static float fastLog2(float x)
+    {
+        // exponent straight from the bits, log2 of the mantissa in [1, 2) from a quartic fit
+        uint32_t bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+
+        auto exponent = static_cast<float>(static_cast<int>((bits >> 23) & 0xff) - 127);
+
+        bits = (bits & 0x007fffffu) | 0x3f800000u;
+        float m;
+        std::memcpy(&m, &bits, sizeof(m));
+
+        return exponent + (-2.49680585f + (4.02845047f + (-2.08112847f + (0.628841381f - 0.0791538172f * m) * m) * m) * m);
+    }
+
+    static float fastExp2(float x)
+    {
+        x = juce::jmax(x, -126.f);
+
+        // 2^floor(x) built as float bits, 2^frac from a cubic that is exactly 1 at 0.
+        // floor as truncate and fix up, which vectorises without SSE4.1
+        auto truncated = static_cast<float>(static_cast<int>(x));
+        auto whole = truncated > x ? truncated - 1.f : truncated;
+        auto frac = x - whole;
+
+        auto bits = static_cast<uint32_t>(static_cast<int>(whole) + 127) << 23;
+        float scale;
+        std::memcpy(&scale, &bits, sizeof(scale));
+
+        return scale * (1.f + frac * (0.695036021f + frac * (0.228308885f + frac * 0.0763248679f)));
+    }
+
+private:
+    // samples per pass through the interleaved sidechain/gain scratch
+    static constexpr int chunkSize = 64;
+
+    struct AlignedFloats
+    {
+        void allocate(int size)
+        {
+            storage.assign(static_cast<size_t>(size + lanes), 0.f);
+            data = Vec::getNextSIMDAlignedPtr(storage.data());
+        }
+
+        float* get() const { return data; }
+
+        std::vector<float> storage;
+        float* data { nullptr };
+    };
+
+    template<Detector mode>
+    static float rectify(SampleType sample)
+    {
+        auto x = static_cast<float>(sample);
+        return mode == Detector::Peak ? std::abs(x) : x * x;
+    }
+
+    template<bool compress>
+    void run(SampleType* const* channels, const SampleType* const* keys, int numChannels, int numSamples)
+    {
+        numChannels = juce::jmin(numChannels, static_cast<int>(channelGroups.size()));
+
+        // until the owner raises the latency to match a new lookahead, look ahead as far as it allows
+        auto detectorDelay = juce::jmax(0, latency - lookaheadSamples);
+
+        // hosts can exceed the prepared block size, keep every chunk inside the ring
+        auto maxChunk = juce::jmin(chunkSize, ringSize - maxDelay);
+
+        for ( auto start = 0; start < numSamples; start += maxChunk )
+        {
+            auto num = juce::jmin(maxChunk, numSamples - start);
+
+            for ( auto ch = 0; ch < numChannels; ++ch )
+            {
+                auto* x = channels[ch] + start;
+                auto* key = keys != nullptr ? keys[ch] + start : x;
+                auto c = static_cast<size_t>(ch);
+
+                outs[c] = x;
+
+                if ( latency == 0 )
+                {
+                    audioIns[c] = x;
+                    detectorIns[c] = key;
+                    continue;
+                }
+
+                auto* ring = rings[c].data();
+                write(ring, x, num);
+
+                auto* detectorRing = ring;
+                if ( keys != nullptr )
+                {
+                    detectorRing = keyRings[c].data();
+                    write(detectorRing, key, num);
+                }
+
+                // both windows end at or before the newest sample, so they're already written
+                detectorIns[c] = detectorRing + ((writePos - detectorDelay) & (ringSize - 1));
+                audioIns[c] = ring + ((writePos - latency) & (ringSize - 1));
+            }
+
+            if ( detector == Detector::Peak )
+                processChunk<Detector::Peak, compress>(numChannels, num);
+            else
+                processChunk<Detector::RMS, compress>(numChannels, num);
+
+            if ( latency > 0 )
+                writePos = (writePos + num) & (ringSize - 1);
+        }
+    }
+
+    void write(SampleType* ring, const SampleType* x, int num) const
+    {
+        for ( auto i = 0; i < num; ++i )
+        {
+            auto pos = (writePos + i) & (ringSize - 1);
+            ring[pos] = ring[pos + ringSize] = x[i];
+        }
+    }
+
+    void clearDelays()
+    {
+        for ( auto* delays : { &rings, &keyRings } )
+            for ( auto& ring : *delays )
+                std::fill(ring.begin(), ring.end(), 0.f);
+    }
+
+    template<Detector mode, bool compress>
+    void processChunk(int numChannels, int num)
+    {
+        auto numActiveBatches = (numGroups + lanes - 1) / lanes;
+        auto batchStride = static_cast<size_t>(chunkSize * lanes);
+
+        // one rectified sidechain per group, interleaved as [batch][sample][lane]
+        std::fill_n(sidechain.get(), static_cast<size_t>(numActiveBatches) * batchStride, 0.f);
+
+        for ( auto ch = 0; ch < numChannels; ++ch )
+        {
+            auto group = channelGroups[static_cast<size_t>(ch)];
+            auto* sc = sidechain.get() + static_cast<size_t>(group / lanes) * batchStride + group % lanes;
+            auto* in = detectorIns[static_cast<size_t>(ch)];
+
+            if ( link == Link::Max || numGroups == numChannels )
+            {
+                for ( auto i = 0; i < num; ++i )
+                    sc[i * lanes] = juce::jmax(sc[i * lanes], rectify<mode>(in[i]));
+            }
+            else
+            {
+                for ( auto i = 0; i < num; ++i )
+                    sc[i * lanes] += rectify<mode>(in[i]);
+            }
+        }
+
+        if ( link == Link::Sum && numGroups < numChannels )
+        {
+            for ( auto batch = 0; batch < numActiveBatches; ++batch )
+            {
+                auto weights = Vec::fromRawArray(groupWeights.get() + batch * lanes);
+                auto* sc = sidechain.get() + static_cast<size_t>(batch) * batchStride;
+
+                for ( auto i = 0; i < num; ++i )
+                    (Vec::fromRawArray(sc + i * lanes) * weights).copyToRawArray(sc + i * lanes);
+            }
+        }
+
+        // the envelope is a weighted average of its start value and the rectified input,
+        // so if neither reaches the knee on any lane the whole batch has a gain of 1
+        auto kneeStart = mode == Detector::Peak ? kneeStartLevel : kneeStartLevel * kneeStartLevel;
+
+        for ( auto batch = 0; batch < numActiveBatches; ++batch )
+        {
+            auto* sc = sidechain.get() + static_cast<size_t>(batch) * batchStride;
+            auto* env = envelopes.get() + batch * lanes;
+
+            auto unity = !compress;
+
+            if constexpr ( compress )
+            {
+                auto peak = *std::max_element(env, env + lanes);
+                for ( auto i = 0; i < num * lanes; ++i )
+                    peak = juce::jmax(peak, sc[i]);
+
+                unity = peak < kneeStart;
+            }
+
+            if ( unity )
+                advance(sc, env, num);
+            else
+                deepestReduction = juce::jmin(deepestReduction, computeGains<mode>(sc, env, gains.get() + static_cast<size_t>(batch) * batchStride, num));
+
+            batchIsUnity[static_cast<size_t>(batch)] = unity;
+        }
+
+        for ( auto ch = 0; ch < numChannels; ++ch )
+        {
+            auto c = static_cast<size_t>(ch);
+            auto group = channelGroups[c];
+
+            auto* audioIn = audioIns[c];
+            auto* out = outs[c];
+
+            // audioIn and out are the same buffer when there is no delay
+            if ( batchIsUnity[static_cast<size_t>(group / lanes)] )
+            {
+                if ( out != audioIn )
+                    std::copy_n(audioIn, num, out);
+
+                continue;
+            }
+
+            auto* gain = gains.get() + static_cast<size_t>(group / lanes) * batchStride + group % lanes;
+
+            for ( auto i = 0; i < num; ++i )
+                out[i] = audioIn[i] * gain[i * lanes];
+        }
+    }
+
+    // in is already rectified, attack where the input rises above the envelope
+    Vec follow(Vec in, Vec env) const
+    {
+        auto cte = Vec::expand(releaseCte) + (Vec::expand(attackCte - releaseCte) & Vec::greaterThan(in, env));
+
+        return in + cte * (env - in);
+    }
+
+    void advance(const float* sc, float* envelope, int num) const
+    {
+        auto env = Vec::fromRawArray(envelope);
+
+        for ( auto i = 0; i < num; ++i )
+            env = follow(Vec::fromRawArray(sc + i * lanes), env);
+
+        env.copyToRawArray(envelope);
+    }
+
+    template<Detector mode>
+    // returns the deepest reduction of any lane, in log2 units (<= 0)
+    float computeGains(const float* sc, float* envelope, float* gain, int num) const
+    {
+        // RMS envelope is power, half the log gives the level
+        const auto levelScale = Vec::expand(mode == Detector::Peak ? 1.f : 0.5f);
+
+        const auto zero = Vec::expand(0.f);
+        const auto threshold = Vec::expand(threshold2);
+        const auto knee = Vec::expand(knee2);
+        const auto halfKnee = Vec::expand(halfKnee2);
+        const auto scale = Vec::expand(kneeScale);
+        const auto ratioSlope = Vec::expand(slope);
+
+        auto env = Vec::fromRawArray(envelope);
+        auto deepest = zero;
+
+        for ( auto i = 0; i < num; ++i )
+        {
+            env = follow(Vec::fromRawArray(sc + i * lanes), env);
+
+            auto over = levelScale * log2(env) - threshold;
+
+            // 0 below the knee, quadratic inside it, slope * over above it
+            auto k = Vec::min(knee, Vec::max(zero, over + halfKnee));
+            auto reduction = ratioSlope * (k * k * scale + Vec::max(over - halfKnee, zero));
+
+            deepest = Vec::min(deepest, reduction);
+            exp2(reduction).copyToRawArray(gain + i * lanes);
+        }
+
+        env.copyToRawArray(envelope);
+
+        auto result = 0.f;
+        for ( size_t lane = 0; lane < static_cast<size_t>(lanes); ++lane )
+            result = juce::jmin(result, deepest.get(lane));
+
+        return result;
+    }
+
+    // same polynomials as fastLog2/fastExp2, a lane at a time
+    static Vec log2(Vec x)
+    {
+        Vec exponent, m;
+        splitFloat(x, exponent, m);
+
+        return exponent + (Vec::expand(-2.49680585f) + (Vec::expand(4.02845047f) + (Vec::expand(-2.08112847f)
+                        + (Vec::expand(0.628841381f) - Vec::expand(0.0791538172f) * m) * m) * m) * m);
+    }
+
+    static Vec exp2(Vec x)
+    {
+        x = Vec::max(x, Vec::expand(-126.f));
+
+        // truncate rounds towards 0, step back one for negative fractions
+        auto truncated = Vec::truncate(x);
+        auto whole = truncated - (Vec::expand(1.f) & Vec::greaterThan(truncated, x));
+        auto frac = x - whole;
+
+        return pow2(whole) * (Vec::expand(1.f) + frac * (Vec::expand(0.695036021f) + frac * (Vec::expand(0.228308885f) + frac * Vec::expand(0.0763248679f))));
+    }
+
+    // unbiased exponent and [1, 2) mantissa of each lane, x > 0
+    static void splitFloat(Vec x, Vec& exponent, Vec& mantissa)
+    {
+       #if JUCE_USE_AVX_INTRINSICS && defined (__AVX2__)
+        auto bits = _mm256_castps_si256(x.value);
+        exponent = Vec::fromNative(_mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127))));
+        mantissa = Vec::fromNative(_mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)), _mm256_set1_epi32(0x3f800000))));
+       #elif JUCE_USE_SSE_INTRINSICS && ! JUCE_USE_AVX_INTRINSICS
+        auto bits = _mm_castps_si128(x.value);
+        exponent = Vec::fromNative(_mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127))));
+        mantissa = Vec::fromNative(_mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)), _mm_set1_epi32(0x3f800000))));
+       #elif JUCE_USE_ARM_NEON
+        auto bits = vreinterpretq_u32_f32(x.value);
+        exponent = Vec::fromNative(vcvtq_f32_s32(vsubq_s32(vreinterpretq_s32_u32(vshrq_n_u32(bits, 23)), vdupq_n_s32(127))));
+        mantissa = Vec::fromNative(vreinterpretq_f32_u32(vorrq_u32(vandq_u32(bits, vdupq_n_u32(0x007fffff)), vdupq_n_u32(0x3f800000))));
+       #else
+        for ( size_t lane = 0; lane < Vec::SIZE; ++lane )
+        {
+            uint32_t bits;
+            auto value = x.get(lane);
+            std::memcpy(&bits, &value, sizeof(bits));
+
+            exponent.set(lane, static_cast<float>(static_cast<int>((bits >> 23) & 0xff) - 127));
+
+            bits = (bits & 0x007fffffu) | 0x3f800000u;
+            std::memcpy(&value, &bits, sizeof(value));
+            mantissa.set(lane, value);
+        }
+       #endif
+    }
+
+    // 2^whole for whole numbers in [-126, 127]
+    static Vec pow2(Vec whole)
+    {
+       #if JUCE_USE_AVX_INTRINSICS && defined (__AVX2__)
+        return Vec::fromNative(_mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(_mm256_cvttps_epi32(whole.value), _mm256_set1_epi32(127)), 23)));
+       #elif JUCE_USE_SSE_INTRINSICS && ! JUCE_USE_AVX_INTRINSICS
+        return Vec::fromNative(_mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(whole.value), _mm_set1_epi32(127)), 23)));
+       #elif JUCE_USE_ARM_NEON
+        return Vec::fromNative(vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(whole.value), vdupq_n_s32(127)), 23)));
+       #else
+        Vec result;
+        for ( size_t lane = 0; lane < Vec::SIZE; ++lane )
+        {
+            auto bits = static_cast<uint32_t>(static_cast<int>(whole.get(lane)) + 127) << 23;
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            result.set(lane, value);
+        }
+        return result;
+       #endif
+    }
+
+    void update()
+    {
+        // everything below is in log2 units, 1 unit = 6.02 dB
+        constexpr auto log2PerDb = 0.166096404f;
+
+        // a hard knee is a very narrow soft one, keeps the gain computer branch free
+        knee2 = juce::jmax(kneeDb * log2PerDb, 1.0e-4f);
+        halfKnee2 = 0.5f * knee2;
+        kneeScale = 1.f / (2.f * knee2);
+
+        threshold2 = thresholdDb * log2PerDb;
+        slope = 1.f / ratio - 1.f;
+
+        kneeStartLevel = std::exp2(threshold2 - halfKnee2);
+
+        auto cte = [expFactor = -2.0 * juce::MathConstants<double>::pi * 1000.0 / sampleRate](float timeMs)
+        {
+            return timeMs < 1.0e-3f ? 0.f : static_cast<float>(std::exp(expFactor / timeMs));
+        };
+
+        attackCte = cte(attackMs);
+        releaseCte = cte(releaseMs);
+
+        lookaheadSamples = juce::jlimit(0, maxDelay, juce::roundToInt(lookaheadMs * 0.001 * sampleRate));
+    }
+
+    double sampleRate { 44100.0 }, preparedRate { 44100.0 };
+
+    float thresholdDb { 0.f }, ratio { 1.f }, attackMs { 1.f }, releaseMs { 100.f }, kneeDb { 0.f }, lookaheadMs { 0.f };
+    Detector detector { Detector::Peak };
+    Link link { Link::Max };
+
+    float threshold2 { 0.f }, knee2 { 1.0e-4f }, halfKnee2 { 0.5e-4f }, kneeScale { 5000.f };
+    float slope { 0.f }, kneeStartLevel { 1.f };
+    float attackCte { 0.f }, releaseCte { 0.f };
+
+    // log2 units, see takeGainReduction()
+    float deepestReduction { 0.f };
+
+    // link groups, one envelope per group packed into lanes
+    std::vector<int> channelGroups;
+    int numGroups { 0 }, numBatches { 0 };
+    AlignedFloats groupWeights;
+
+    // interleaved [batch][sample][lane], aligned for SIMDRegister loads
+    AlignedFloats envelopes, sidechain, gains;
+    std::vector<uint8_t> batchIsUnity;
+
+    // per channel read/write positions for the current chunk
+    std::vector<const SampleType*> detectorIns, audioIns;
+    std::vector<SampleType*> outs;
+
+    int lookaheadSamples { 0 }, latency { 0 };
+
+    // per channel delay lines for the audio and the external key, written in lockstep
+    // so they share one write position
+    int maxDelay { 0 }, ringSize { 1 }, writePos { 0 };
+    std::vector<std::vector<SampleType>> rings, keyRings;
+};
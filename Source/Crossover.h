@@ -0,0 +1,451 @@
+/*
+  ==============================================================================
+
+    Crossover.h
+    Created: 16 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/*
+    N band Linkwitz-Riley crossover as a single fused filter tree.
+
+    Uses the same TPT state variable sections as juce::dsp::LinkwitzRileyFilter,
+    but reads each input sample once and writes straight into the band outputs.
+    Each split peels the lowest band off the remainder, and every band that leaves
+    the tree early gets an allpass at each higher crossover to stay in phase.
+    For 3 bands:
+
+        x -> split(fc0) -> low  -> allpass(fc1)              -> band 0
+                        -> high -> split(fc1) -> low          -> band 1
+                                              -> high         -> band 2
+
+    The lowpass and highpass of a split share their first section (LP1 and HP1
+    used to run identical first stages on identical input), so the 3 band output
+    matches the old LP1/AP2/HP1/LP2/HP2 chain.
+
+    Channels are packed into the lanes of a juce::dsp::SIMDRegister (SSE/NEON, or
+    AVX when the build enables it) and the whole tree runs once per lane group.
+    A single left-over channel takes the scalar path instead of wasting a register.
+    SampleType is float or double, for hosts that process in double precision.
+
+    A new crossover frequency isn't jumped to, it glides there in log frequency over
+    smoothingSeconds. While anything is gliding the tree runs updateInterval samples at
+    a time and the moving crossovers' coefficients are redone in between, with tan()
+    from TanTable. The slices carry on across process() calls, so a glide takes the
+    same number of samples however the host and the caller cut up the blocks. Once a
+    glide lands the exact coefficients are put back, so a crossover that isn't moving
+    costs and sounds exactly as before.
+*/
+
+// tan(pi * w) for w = cutoff / sampleRate, linearly interpolated from a table - accurate
+// to a few parts per million up to w = 0.45 (20kHz at 44.1kHz), cheap enough to redo
+// every few samples of a glide
+struct TanTable
+{
+    static constexpr int size = 4096;
+    static constexpr float maxW = 0.49f;
+
+    static float lookup(float w)
+    {
+        const auto& table = get();
+
+        auto pos = juce::jlimit(0.f, 1.f, w / maxW) * static_cast<float>(size);
+        auto i = juce::jmin(static_cast<int>(pos), size - 1);
+        auto frac = pos - static_cast<float>(i);
+
+        return table[static_cast<size_t>(i)] + frac * (table[static_cast<size_t>(i + 1)] - table[static_cast<size_t>(i)]);
+    }
+
+    // built on first use, Crossover::prepare() makes sure that's not on the audio thread
+    static const std::array<float, size + 1>& get()
+    {
+        static const auto table = []
+        {
+            std::array<float, size + 1> t;
+
+            for ( size_t i = 0; i <= size; ++i )
+                t[i] = static_cast<float>(std::tan(juce::MathConstants<double>::pi * maxW * static_cast<double>(i) / size));
+
+            return t;
+        }();
+
+        return table;
+    }
+};
+
+template<size_t NumBands, typename SampleType = float>
+struct Crossover
+{
+    static_assert(NumBands >= 2, "a crossover needs at least 2 bands");
+
+    static constexpr size_t numBands = NumBands;
+    static constexpr size_t numCrossovers = NumBands - 1;
+    static constexpr size_t numAllpasses = (NumBands - 1) * (NumBands - 2) / 2;
+
+    using Vec = juce::dsp::SIMDRegister<SampleType>;
+    static constexpr int lanes = static_cast<int>(Vec::SIZE);
+
+    // glide length, and how often the coefficients follow along
+    static constexpr double smoothingSeconds = 0.05;
+    static constexpr int updateInterval = 16;
+
+    Crossover()
+    {
+        // placeholder spacing until the owner sets real frequencies
+        for ( size_t i = 0; i < numCrossovers; ++i )
+            cutoffs[i].setCurrentAndTargetValue(100.f * std::pow(100.f, static_cast<float>(i) / static_cast<float>(numCrossovers)));
+    }
+
+    // jumps straight to the frequencies set so far, set them first to start from there
+    void prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        sampleRate = spec.sampleRate;
+
+        // smoothers step once per update, not per sample
+        for ( auto& cutoff : cutoffs )
+            cutoff.reset(sampleRate / updateInterval, smoothingSeconds);
+
+        TanTable::get();
+
+        auto numChannels = static_cast<int>(spec.numChannels);
+        numVectorGroups = numChannels / lanes;
+
+        // a remainder of 2+ channels still beats running them one by one
+        if ( numChannels % lanes > 1 )
+            ++numVectorGroups;
+
+        vectorState.resize(static_cast<size_t>(numVectorGroups));
+        scalarState.resize(static_cast<size_t>(juce::jmax(0, numChannels - numVectorGroups * lanes)));
+
+        reset();
+    }
+
+    // back to silence, with any glide finished
+    void reset()
+    {
+        std::fill(vectorState.begin(), vectorState.end(), ChannelState<Vec>{});
+        std::fill(scalarState.begin(), scalarState.end(), ChannelState<SampleType>{});
+
+        for ( size_t i = 0; i < numCrossovers; ++i )
+        {
+            cutoffs[i].setCurrentAndTargetValue(cutoffs[i].getTargetValue());
+            updateCoefficients(i);
+        }
+
+        smoothing = false;
+        sliceRemaining = 0;
+    }
+
+    // glides from the current frequency, over smoothingSeconds
+    void setCrossoverFrequency(size_t index, float freq)
+    {
+        jassert(index < numCrossovers);
+
+        cutoffs[index].setTargetValue(freq);
+        smoothing = smoothing || cutoffs[index].isSmoothing();
+    }
+
+    // seconds for the tree to ring down by decayDb once the input stops. The lowest
+    // crossover's poles are the slowest, a Butterworth section decays at w0 / sqrt2 and
+    // the second one of each LR4 pair stretches that a little - the extra half covers it
+    double getTailSeconds(double decayDb) const
+    {
+        // wherever a glide ends up, the lower end of it rings the longest
+        auto lowest = juce::jmin(cutoffs[0].getCurrentValue(), cutoffs[0].getTargetValue());
+        auto decay = juce::MathConstants<double>::twoPi * lowest / juce::MathConstants<double>::sqrt2;
+        return 1.5 * decayDb / 20.0 * std::log(10.0) / decay;
+    }
+
+    // splits as many channels as the band buffers have, reading input from inputStart
+    void process(const juce::AudioBuffer<SampleType>& input, std::array<juce::AudioBuffer<SampleType>, numBands>& bands, int numSamples,
+                 int inputStart = 0)
+    {
+        runSlices(numSamples, [&](int start, int num)
+        {
+            processRange(input, inputStart + start, bands, start, num);
+        });
+    }
+
+    // the glides carry on for numSamples without any audio, for a caller that skips silent blocks
+    void skip(int numSamples)
+    {
+        runSlices(numSamples, [](int, int) {});
+    }
+
+private:
+    // hands numSamples to processSlice(start, num) in pieces that line up with the glide's
+    // updates, the first one finishing the slice an earlier call left off in. With nothing
+    // gliding the rest goes in one piece
+    template<typename Fn>
+    void runSlices(int numSamples, Fn&& processSlice)
+    {
+        for ( auto start = 0; start < numSamples; )
+        {
+            if ( sliceRemaining == 0 )
+            {
+                if ( !smoothing )
+                {
+                    processSlice(start, numSamples - start);
+                    return;
+                }
+
+                advanceSmoothing();
+                sliceRemaining = updateInterval;
+            }
+
+            auto num = juce::jmin(sliceRemaining, numSamples - start);
+            processSlice(start, num);
+
+            sliceRemaining -= num;
+            start += num;
+        }
+    }
+
+    void processRange(const juce::AudioBuffer<SampleType>& input, int inputStart, std::array<juce::AudioBuffer<SampleType>, numBands>& bands,
+                      int outputStart, int numSamples)
+    {
+        auto numChannels = juce::jmin(input.getNumChannels(), bands[0].getNumChannels());
+
+        for ( auto group = 0; group < numVectorGroups; ++group )
+        {
+            auto firstChannel = group * lanes;
+            auto groupSize = juce::jmin(lanes, numChannels - firstChannel);
+
+            if ( groupSize > 0 )
+                processGroup(input, inputStart, bands, outputStart, firstChannel, groupSize, numSamples, vectorState[static_cast<size_t>(group)]);
+        }
+
+        for ( size_t i = 0; i < scalarState.size(); ++i )
+        {
+            auto ch = numVectorGroups * lanes + static_cast<int>(i);
+
+            if ( ch < numChannels )
+                processChannel(input, inputStart, bands, outputStart, ch, numSamples, scalarState[i]);
+        }
+    }
+
+    // one update's worth of every glide, table coefficients while still moving
+    void advanceSmoothing()
+    {
+        auto stillMoving = false;
+
+        for ( size_t i = 0; i < numCrossovers; ++i )
+        {
+            auto& cutoff = cutoffs[i];
+
+            if ( !cutoff.isSmoothing() )
+                continue;
+
+            auto freq = cutoff.getNextValue();
+
+            if ( cutoff.isSmoothing() )
+            {
+                setCoefficients(i, TanTable::lookup(static_cast<float>(freq / sampleRate)));
+                stillMoving = true;
+            }
+            else
+            {
+                updateCoefficients(i);
+            }
+        }
+
+        smoothing = stillMoving;
+    }
+
+    template<typename Value>
+    struct Coefficients
+    {
+        Value g, h, R2, R2plusG;
+    };
+
+    template<typename Value>
+    struct Outputs
+    {
+        Value yH, yB, yL;
+    };
+
+    // one 2nd order state variable section
+    template<typename Value>
+    struct Section
+    {
+        Value s1 {}, s2 {};
+
+        Outputs<Value> tick(Value x, const Coefficients<Value>& c)
+        {
+            auto yH = (x - c.R2plusG * s1 - s2) * c.h;
+
+            auto yB = c.g * yH + s1;
+            s1 = c.g * yH + yB;
+
+            auto yL = c.g * yB + s2;
+            s2 = c.g * yB + yL;
+
+            return { yH, yB, yL };
+        }
+    };
+
+    // LR4 lowpass/highpass pair, both outputs from a shared first section
+    template<typename Value>
+    struct Split
+    {
+        Section<Value> first, low, high;
+    };
+
+    template<typename Value>
+    struct ChannelState
+    {
+        std::array<Split<Value>, numCrossovers> splits;
+        std::array<Section<Value>, numAllpasses> allpasses;
+    };
+
+    template<typename Value>
+    using CoefficientSet = std::array<Coefficients<Value>, numCrossovers>;
+
+    template<typename Value>
+    static void split(Value x, const Coefficients<Value>& c, Split<Value>& s, Value& lowOut, Value& highOut)
+    {
+        auto y = s.first.tick(x, c);
+
+        lowOut = s.low.tick(y.yL, c).yL;
+        highOut = s.high.tick(y.yH, c).yH;
+    }
+
+    template<typename Value>
+    static Value allpass(Value x, const Coefficients<Value>& c, Section<Value>& s)
+    {
+        auto y = s.tick(x, c);
+
+        return y.yL - c.R2 * y.yB + y.yH;
+    }
+
+    // all loop bounds are compile time constants, so this unrolls into the flat tree
+    template<typename Value>
+    static void tree(Value x, const CoefficientSet<Value>& c, ChannelState<Value>& s, std::array<Value, numBands>& out)
+    {
+        auto rest = x;
+        size_t ap = 0;
+
+        for ( size_t k = 0; k < numCrossovers; ++k )
+        {
+            Value low;
+            split(rest, c[k], s.splits[k], low, rest);
+
+            for ( auto j = k + 1; j < numCrossovers; ++j )
+                low = allpass(low, c[j], s.allpasses[ap++]);
+
+            out[k] = low;
+        }
+
+        out[numCrossovers] = rest;
+    }
+
+    void processChannel(const juce::AudioBuffer<SampleType>& input, int inputStart, std::array<juce::AudioBuffer<SampleType>, numBands>& bands,
+                        int outputStart, int ch, int numSamples, ChannelState<SampleType>& s)
+    {
+        auto* x = input.getReadPointer(ch, inputStart);
+
+        std::array<SampleType*, numBands> out;
+        for ( size_t band = 0; band < numBands; ++band )
+            out[band] = bands[band].getWritePointer(ch, outputStart);
+
+        std::array<SampleType, numBands> y;
+
+        for ( auto i = 0; i < numSamples; ++i )
+        {
+            tree(x[i], scalarCoefficients, s, y);
+
+            for ( size_t band = 0; band < numBands; ++band )
+                out[band][i] = y[band];
+        }
+    }
+
+    void processGroup(const juce::AudioBuffer<SampleType>& input, int inputStart, std::array<juce::AudioBuffer<SampleType>, numBands>& bands,
+                      int outputStart, int firstChannel, int groupSize, int numSamples, ChannelState<Vec>& s)
+    {
+        const SampleType* x[lanes] {};
+        SampleType* out[numBands][lanes] {};
+
+        for ( auto lane = 0; lane < groupSize; ++lane )
+        {
+            x[lane] = input.getReadPointer(firstChannel + lane, inputStart);
+
+            for ( size_t band = 0; band < numBands; ++band )
+                out[band][lane] = bands[band].getWritePointer(firstChannel + lane, outputStart);
+        }
+
+        // interleave a chunk of samples into registers, run the tree, de-interleave
+        for ( auto start = 0; start < numSamples; start += chunkSize )
+        {
+            auto num = juce::jmin(chunkSize, numSamples - start);
+
+            for ( auto lane = 0; lane < groupSize; ++lane )
+                for ( auto i = 0; i < num; ++i )
+                    inChunk[static_cast<size_t>(i * lanes + lane)] = x[lane][start + i];
+
+            for ( auto i = 0; i < num; ++i )
+            {
+                auto idx = static_cast<size_t>(i * lanes);
+                std::array<Vec, numBands> y;
+
+                tree(Vec::fromRawArray(inChunk.data() + idx), vectorCoefficients, s, y);
+
+                for ( size_t band = 0; band < numBands; ++band )
+                    y[band].copyToRawArray(outChunk[band].data() + idx);
+            }
+
+            for ( size_t band = 0; band < numBands; ++band )
+                for ( auto lane = 0; lane < groupSize; ++lane )
+                    for ( auto i = 0; i < num; ++i )
+                        out[band][lane][start + i] = outChunk[band][static_cast<size_t>(i * lanes + lane)];
+        }
+    }
+
+    // exact, for a crossover that's standing still
+    void updateCoefficients(size_t index)
+    {
+        double cutoff = cutoffs[index].getCurrentValue();
+        jassert(cutoff > 0 && cutoff < sampleRate * 0.5);
+
+        setCoefficients(index, std::tan(juce::MathConstants<double>::pi * cutoff / sampleRate));
+    }
+
+    void setCoefficients(size_t index, double g)
+    {
+        // worked out in double either way, the low crossovers at high rates need it
+        auto R2 = juce::MathConstants<double>::sqrt2;
+
+        auto& c = scalarCoefficients[index];
+        c.R2 = static_cast<SampleType>(R2);
+        c.g = static_cast<SampleType>(g);
+        c.h = static_cast<SampleType>(1.0 / (1.0 + R2 * g + g * g));
+        c.R2plusG = static_cast<SampleType>(R2 + g);
+
+        vectorCoefficients[index] = { Vec::expand(c.g), Vec::expand(c.h), Vec::expand(c.R2), Vec::expand(c.R2plusG) };
+    }
+
+    static constexpr int chunkSize = 32;
+
+    double sampleRate { 44100.0 };
+
+    // log frequency glides, so a sweep sounds even across the whole range
+    std::array<juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative>, numCrossovers> cutoffs;
+    bool smoothing { false };
+
+    // samples left at the current coefficients, before the next update
+    int sliceRemaining { 0 };
+
+    CoefficientSet<SampleType> scalarCoefficients;
+    CoefficientSet<Vec> vectorCoefficients;
+
+    int numVectorGroups { 0 };
+    std::vector<ChannelState<Vec>> vectorState;
+    std::vector<ChannelState<SampleType>> scalarState;
+
+    alignas(Vec) std::array<SampleType, chunkSize * lanes> inChunk {};
+    alignas(Vec) std::array<std::array<SampleType, chunkSize * lanes>, numBands> outChunk {};
+};
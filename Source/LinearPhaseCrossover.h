@@ -0,0 +1,454 @@
+/*
+  ==============================================================================
+
+    LinearPhaseCrossover.h
+    Created: 16 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/*
+    N band linear phase crossover, same interface as Crossover.
+
+    Each band is an FIR designed from Linkwitz-Riley magnitudes. Band k gets the LR4
+    lowpass at crossover k times the LR4 highpass of every crossover below it, so the
+    band magnitudes add up to exactly 1 and the bands sum back to a pure delay.
+
+    The FIRs run as uniformly partitioned overlap-save convolution: every
+    partitionSize input samples cost one FFT per channel, one multiply-accumulate over
+    the spectrum history per band and one inverse FFT per band. The partition is as
+    small as a 64 sample host block, so every block does the same amount of work
+    instead of saving it up for one long FFT.
+
+    Kernels are rebuilt on a background thread when a crossover moves. The audio
+    thread picks up finished kernels through an atomic slot exchange and crossfades
+    from the old kernels over one partition. The builder only runs while the crossover
+    is active, and sleeps until notifyBuilder() says a crossover moved.
+
+    juce::dsp::FFT only runs in float, so double precision buffers are converted on
+    the way in and out - an FIR's precision doesn't depend on the cutoff the way an
+    IIR's does, so float is plenty here.
+*/
+template<size_t NumBands>
+struct LinearPhaseCrossover
+{
+    static_assert(NumBands >= 2, "a crossover needs at least 2 bands");
+
+    static constexpr size_t numBands = NumBands;
+    static constexpr size_t numCrossovers = NumBands - 1;
+
+    static constexpr int partitionSize = 64;
+
+    LinearPhaseCrossover() : builder(*this)
+    {
+        for ( size_t i = 0; i < numCrossovers; ++i )
+            targetCutoffs[i].store(100.f * std::pow(100.f, static_cast<float>(i) / static_cast<float>(numCrossovers)));
+    }
+
+    ~LinearPhaseCrossover()
+    {
+        builder.stopThread(1000);
+    }
+
+    void prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        // the builder owns the kernel slots while it runs
+        builder.stopThread(1000);
+        ready.store(false);
+
+        sampleRate = spec.sampleRate;
+
+        // ~40ms of kernel, enough for the low crossover range to still have a usable slope
+        kernelSize = juce::jmax(2 * partitionSize, juce::nextPowerOfTwo(static_cast<int>(sampleRate * 0.04)));
+        numPartitions = kernelSize / partitionSize;
+
+        kernelFFT = std::make_unique<juce::dsp::FFT>(juce::roundToInt(std::log2(kernelSize)));
+        kernelBuffer.assign(static_cast<size_t>(2 * kernelSize), 0.f);
+        builderFFTBuffer.assign(static_cast<size_t>(2 * fftSize), 0.f);
+
+        for ( auto& slot : slots )
+        {
+            slot.re.assign(static_cast<size_t>(numBands) * static_cast<size_t>(numPartitions) * numBins, 0.f);
+            slot.im.assign(slot.re.size(), 0.f);
+        }
+
+        channels.resize(spec.numChannels);
+        for ( auto& state : channels )
+        {
+            state.input.assign(static_cast<size_t>(fftSize), 0.f);
+            state.historyRe.assign(static_cast<size_t>(numPartitions) * numBins, 0.f);
+            state.historyIm.assign(state.historyRe.size(), 0.f);
+
+            for ( auto& out : state.outputs )
+                out.assign(static_cast<size_t>(partitionSize), 0.f);
+        }
+
+        activeSlot = 0;
+        previousSlot = 1;
+        readySlot.store(2);
+        builderSlot = 3;
+
+        // first kernels are built right here so the first block is already correct
+        if ( active )
+        {
+            auto generation = requestedGeneration.load();
+            buildKernels(slots[0]);
+            builtGeneration = generation;
+            ready.store(true);
+        }
+
+        reset();
+
+        prepared = true;
+
+        if ( active )
+            builder.startThread();
+    }
+
+    // message thread. Inactive, no kernels are built and the builder thread is stopped,
+    // active again it starts over with kernels for the current frequencies
+    void setActive(bool shouldBeActive)
+    {
+        if ( shouldBeActive == active )
+            return;
+
+        active = shouldBeActive;
+
+        if ( !prepared )
+            return;
+
+        if ( active )
+        {
+            builder.startThread();
+        }
+        else
+        {
+            builder.stopThread(1000);
+            ready.store(false);
+        }
+    }
+
+    // true once the builder has kernels for a recent set of frequencies, the audio
+    // thread shouldn't switch to this crossover before
+    bool hasKernels() const { return ready.load(std::memory_order_acquire); }
+
+    // message thread, wakes the builder if a crossover moved since the last call.
+    // The audio thread can't do it itself, signalling the builder takes a lock
+    void notifyBuilder()
+    {
+        auto generation = requestedGeneration.load();
+
+        if ( active && generation != notifiedGeneration )
+        {
+            notifiedGeneration = generation;
+            builder.notify();
+        }
+    }
+
+    void reset()
+    {
+        for ( auto& state : channels )
+        {
+            std::fill(state.input.begin(), state.input.end(), 0.f);
+            std::fill(state.historyRe.begin(), state.historyRe.end(), 0.f);
+            std::fill(state.historyIm.begin(), state.historyIm.end(), 0.f);
+
+            for ( auto& out : state.outputs )
+                std::fill(out.begin(), out.end(), 0.f);
+        }
+
+        fillPos = 0;
+        historyPos = 0;
+    }
+
+    // one partition of buffering plus the kernel's centre tap
+    int getLatencySamples() const { return partitionSize + kernelSize / 2; }
+
+    // safe from any thread, the kernels follow on the builder thread after notifyBuilder()
+    void setCrossoverFrequency(size_t index, float freq)
+    {
+        jassert(index < numCrossovers);
+
+        if ( targetCutoffs[index].exchange(freq) != freq )
+            requestedGeneration.fetch_add(1);
+    }
+
+    template<typename SampleType>
+    void process(const juce::AudioBuffer<SampleType>& input, std::array<juce::AudioBuffer<SampleType>, numBands>& bands, int numSamples,
+                 int inputStart = 0)
+    {
+        auto numChannels = juce::jmin(input.getNumChannels(), bands[0].getNumChannels(), static_cast<int>(channels.size()));
+
+        for ( auto start = 0; start < numSamples; )
+        {
+            auto num = juce::jmin(partitionSize - fillPos, numSamples - start);
+
+            // the outputs hold the previous partition's result, handed out while the next one fills
+            for ( auto ch = 0; ch < numChannels; ++ch )
+            {
+                auto& state = channels[static_cast<size_t>(ch)];
+
+                std::copy_n(input.getReadPointer(ch, inputStart + start), num, state.input.data() + partitionSize + fillPos);
+
+                for ( size_t band = 0; band < numBands; ++band )
+                    std::copy_n(state.outputs[band].data() + fillPos, num, bands[band].getWritePointer(ch, start));
+            }
+
+            fillPos += num;
+            start += num;
+
+            if ( fillPos == partitionSize )
+            {
+                step(numChannels);
+                fillPos = 0;
+            }
+        }
+    }
+
+private:
+    static constexpr int fftSize = 2 * partitionSize;
+    static constexpr size_t numBins = partitionSize + 1;
+
+    // spectra of every partition of every band's kernel, split re/im so the
+    // multiply-accumulate vectorises
+    struct KernelSlot
+    {
+        std::vector<float> re, im;
+
+        size_t offset(size_t band, int partition, int partitions) const
+        {
+            return (band * static_cast<size_t>(partitions) + static_cast<size_t>(partition)) * numBins;
+        }
+    };
+
+    struct ChannelState
+    {
+        // previous partition followed by the one being filled
+        std::vector<float> input;
+
+        // input spectra of the last numPartitions partitions, a ring indexed by historyPos
+        std::vector<float> historyRe, historyIm;
+
+        std::array<std::vector<float>, numBands> outputs;
+    };
+
+    struct Builder : juce::Thread
+    {
+        Builder(LinearPhaseCrossover& o) : juce::Thread("Linear Phase Kernels"), owner(o) {}
+
+        void run() override
+        {
+            while ( !threadShouldExit() )
+            {
+                if ( !owner.rebuildIfNeeded() )
+                    wait(-1);
+            }
+        }
+
+        LinearPhaseCrossover& owner;
+    };
+
+    // nothing is ready after a restart, frequencies may have moved while the builder was stopped
+    bool rebuildIfNeeded()
+    {
+        auto generation = requestedGeneration.load();
+        if ( generation == builtGeneration && ready.load() )
+            return false;
+
+        buildKernels(slots[static_cast<size_t>(builderSlot)]);
+        builtGeneration = generation;
+
+        // publish, and take back whichever slot the audio thread last retired
+        builderSlot = readySlot.exchange(builderSlot | freshFlag, std::memory_order_acq_rel) & slotMask;
+        ready.store(true, std::memory_order_release);
+        return true;
+    }
+
+    void buildKernels(KernelSlot& slot)
+    {
+        std::array<float, numCrossovers> cutoffs;
+        for ( size_t i = 0; i < numCrossovers; ++i )
+            cutoffs[i] = juce::jlimit(1.f, static_cast<float>(sampleRate * 0.49), targetCutoffs[i].load());
+
+        auto half = kernelSize / 2;
+
+        for ( size_t band = 0; band < numBands; ++band )
+        {
+            std::fill(kernelBuffer.begin(), kernelBuffer.end(), 0.f);
+
+            // zero phase magnitude response, real valued, bins 0 to N/2
+            for ( auto k = 0; k <= half; ++k )
+            {
+                auto f = static_cast<float>(k * sampleRate / kernelSize);
+                auto gain = 1.f;
+
+                for ( size_t i = 0; i < numCrossovers && i <= band; ++i )
+                {
+                    auto r = f / cutoffs[i];
+                    auto r4 = r * r * r * r;
+                    auto lowpass = 1.f / (1.f + r4);
+
+                    gain *= i == band ? lowpass : 1.f - lowpass;
+                }
+
+                kernelBuffer[static_cast<size_t>(2 * k)] = gain;
+            }
+
+            kernelFFT->performRealOnlyInverseTransform(kernelBuffer.data());
+
+            // centre the impulse and window it. The band impulses only add up to something
+            // non zero at the centre, where the periodic Hann window is exactly 1, so the
+            // windowed bands still sum to a pure delay
+            for ( auto p = 0; p < numPartitions; ++p )
+            {
+                std::fill(builderFFTBuffer.begin(), builderFFTBuffer.end(), 0.f);
+
+                for ( auto i = 0; i < partitionSize; ++i )
+                {
+                    auto n = p * partitionSize + i;
+                    auto window = 0.5f - 0.5f * std::cos(juce::MathConstants<float>::twoPi * static_cast<float>(n) / static_cast<float>(kernelSize));
+
+                    builderFFTBuffer[static_cast<size_t>(i)] = kernelBuffer[static_cast<size_t>((n + half) % kernelSize)] * window;
+                }
+
+                partitionFFT.performRealOnlyForwardTransform(builderFFTBuffer.data(), true);
+
+                auto offset = slot.offset(band, p, numPartitions);
+                for ( size_t k = 0; k < numBins; ++k )
+                {
+                    slot.re[offset + k] = builderFFTBuffer[2 * k];
+                    slot.im[offset + k] = builderFFTBuffer[2 * k + 1];
+                }
+            }
+        }
+    }
+
+    void step(int numChannels)
+    {
+        // new kernels: hand back the slot retired at the last swap, keep the current
+        // one around for this partition's crossfade
+        auto fading = false;
+        if ( readySlot.load(std::memory_order_acquire) & freshFlag )
+        {
+            auto fresh = readySlot.exchange(previousSlot, std::memory_order_acq_rel) & slotMask;
+            previousSlot = activeSlot;
+            activeSlot = fresh;
+            fading = true;
+        }
+
+        for ( auto ch = 0; ch < numChannels; ++ch )
+        {
+            auto& state = channels[static_cast<size_t>(ch)];
+
+            // overlap-save: spectrum of the last two partitions of input
+            std::copy(state.input.begin(), state.input.end(), fftBuffer.begin());
+            std::fill(fftBuffer.begin() + fftSize, fftBuffer.end(), 0.f);
+            audioFFT.performRealOnlyForwardTransform(fftBuffer.data(), true);
+
+            auto historyOffset = static_cast<size_t>(historyPos) * numBins;
+            for ( size_t k = 0; k < numBins; ++k )
+            {
+                state.historyRe[historyOffset + k] = fftBuffer[2 * k];
+                state.historyIm[historyOffset + k] = fftBuffer[2 * k + 1];
+            }
+
+            std::copy(state.input.begin() + partitionSize, state.input.end(), state.input.begin());
+
+            for ( size_t band = 0; band < numBands; ++band )
+            {
+                auto& out = state.outputs[band];
+                convolve(state, slots[static_cast<size_t>(activeSlot)], band, out.data());
+
+                if ( fading )
+                {
+                    convolve(state, slots[static_cast<size_t>(previousSlot)], band, fadeBuffer.data());
+
+                    for ( auto i = 0; i < partitionSize; ++i )
+                    {
+                        auto t = static_cast<float>(i + 1) / static_cast<float>(partitionSize);
+                        out[static_cast<size_t>(i)] = fadeBuffer[static_cast<size_t>(i)] + t * (out[static_cast<size_t>(i)] - fadeBuffer[static_cast<size_t>(i)]);
+                    }
+                }
+            }
+        }
+
+        historyPos = (historyPos + 1) % numPartitions;
+    }
+
+    void convolve(const ChannelState& state, const KernelSlot& slot, size_t band, float* dest)
+    {
+        std::fill(accRe.begin(), accRe.end(), 0.f);
+        std::fill(accIm.begin(), accIm.end(), 0.f);
+
+        // partition p of the kernel meets the input from p partitions ago
+        for ( auto p = 0; p < numPartitions; ++p )
+        {
+            auto h = (historyPos - p + numPartitions) % numPartitions;
+
+            auto* xRe = state.historyRe.data() + static_cast<size_t>(h) * numBins;
+            auto* xIm = state.historyIm.data() + static_cast<size_t>(h) * numBins;
+
+            auto offset = slot.offset(band, p, numPartitions);
+            auto* hRe = slot.re.data() + offset;
+            auto* hIm = slot.im.data() + offset;
+
+            for ( size_t k = 0; k < numBins; ++k )
+            {
+                accRe[k] += xRe[k] * hRe[k] - xIm[k] * hIm[k];
+                accIm[k] += xRe[k] * hIm[k] + xIm[k] * hRe[k];
+            }
+        }
+
+        for ( size_t k = 0; k < numBins; ++k )
+        {
+            fftBuffer[2 * k] = accRe[k];
+            fftBuffer[2 * k + 1] = accIm[k];
+        }
+
+        audioFFT.performRealOnlyInverseTransform(fftBuffer.data());
+
+        // the second half is free of circular wrap around
+        std::copy_n(fftBuffer.data() + partitionSize, partitionSize, dest);
+    }
+
+    double sampleRate { 44100.0 };
+    int kernelSize { 2 * partitionSize }, numPartitions { 2 };
+
+    // audio thread
+    juce::dsp::FFT audioFFT { juce::roundToInt(std::log2(fftSize)) };
+    std::array<float, 2 * fftSize> fftBuffer {};
+    std::array<float, numBins> accRe {}, accIm {};
+    std::array<float, partitionSize> fadeBuffer {};
+
+    std::vector<ChannelState> channels;
+    int fillPos { 0 }, historyPos { 0 };
+
+    // builder thread (and prepare, while the builder is stopped)
+    juce::dsp::FFT partitionFFT { juce::roundToInt(std::log2(fftSize)) };
+    std::unique_ptr<juce::dsp::FFT> kernelFFT;
+    std::vector<float> kernelBuffer, builderFFTBuffer;
+
+    // four kernel slots: the audio thread owns the active one and the one it is fading
+    // from, the builder owns one, and one is parked in readySlot for the exchange
+    static constexpr int freshFlag = 4;
+    static constexpr int slotMask = 3;
+
+    std::array<KernelSlot, 4> slots;
+    int activeSlot { 0 }, previousSlot { 1 }, builderSlot { 3 };
+    std::atomic<int> readySlot { 2 };
+
+    std::array<std::atomic<float>, numCrossovers> targetCutoffs;
+    std::atomic<uint32_t> requestedGeneration { 0 };
+    uint32_t builtGeneration { 0 };
+    std::atomic<bool> ready { false };
+
+    // message thread
+    bool active { true }, prepared { false };
+    uint32_t notifiedGeneration { 0 };
+
+    Builder builder;
+};
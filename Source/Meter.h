@@ -0,0 +1,196 @@
+/*
+  ==============================================================================
+
+    Meter.h
+    Created: 17 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Metering.h"
+#include "Rendering.h"
+
+/*
+    Calls back in step with the display where JUCE can sync to it (VBlankAttachment,
+    JUCE 7 and later), from a timer otherwise. Either way no more than maxHz times a
+    second, a 144 Hz display doesn't need meters redrawn at 144 Hz - and less often while
+    the FrameBudget is overrun, down to minHz.
+    The callback gets the seconds since the last one, for the meters' ballistics.
+*/
+struct MeterRefresh
+#if JUCE_MAJOR_VERSION < 7
+    : private juce::Timer
+#endif
+{
+    MeterRefresh(juce::Component* owner, std::function<void(double)> onRefresh, double maxHz = 60.0)
+        : callback(std::move(onRefresh)), minInterval(1.0 / maxHz), interval(minInterval)
+       #if JUCE_MAJOR_VERSION >= 7
+        , vblank(owner, [this] { tick(); })
+       #endif
+    {
+       #if JUCE_MAJOR_VERSION < 7
+        juce::ignoreUnused(owner);
+        startTimerHz(juce::roundToInt(maxHz));
+       #endif
+    }
+    
+private:
+    void tick()
+    {
+        auto now = juce::Time::getMillisecondCounterHiRes() * 0.001;
+        auto elapsed = now - lastRefresh;
+        
+        // a little slack so a 60 Hz display isn't halved by jitter at maxHz = 60
+        if ( elapsed < 0.9 * interval )
+            return;
+        
+        adaptInterval();
+        
+        lastRefresh = now;
+        
+        FrameBudget::Scope cost;
+        callback(juce::jmin(elapsed, maxInterval));
+    }
+    
+    // once per budget window: back off quickly while over, creep back up once well under
+    void adaptInterval()
+    {
+        auto window = 0;
+        auto load = FrameBudget::getLoad(window);
+        
+        if ( window == adaptedWindow )
+            return;
+        
+        adaptedWindow = window;
+        
+        if ( load > FrameBudget::budget )
+            interval = juce::jmin(maxInterval, interval * 1.5);
+        else if ( load < 0.5 * FrameBudget::budget )
+            interval = juce::jmax(minInterval, interval / 1.25);
+    }
+    
+   #if JUCE_MAJOR_VERSION < 7
+    void timerCallback() override { tick(); }
+   #endif
+    
+    // 10 Hz at the slowest, meters get hard to read below that
+    static constexpr double maxInterval = 0.1;
+    
+    std::function<void(double)> callback;
+    double minInterval, interval, lastRefresh { 0.0 };
+    int adaptedWindow { 0 };
+    
+   #if JUCE_MAJOR_VERSION >= 7
+    juce::VBlankAttachment vblank;
+   #endif
+};
+
+// vertical bar, RMS filled and the peak as a line that holds and then falls
+struct LevelMeter : juce::Component
+{
+    static constexpr float minDb = -60.f;
+    
+    // paint() covers every pixel, so a repaint never reaches the band behind
+    LevelMeter() { setOpaque(true); }
+    
+    void update(const MeterLevels& levels, bool hasNewLevels, double elapsedSeconds)
+    {
+        auto newPeak = hasNewLevels ? juce::Decibels::gainToDecibels(levels.peak, minDb) : minDb;
+        auto newRms = hasNewLevels ? juce::Decibels::gainToDecibels(levels.getRMS(), minDb) : minDb;
+        
+        holdSeconds += elapsedSeconds;
+        
+        if ( newPeak >= peakDb )
+        {
+            peakDb = newPeak;
+            holdSeconds = 0.0;
+        }
+        else if ( holdSeconds > peakHoldSeconds )
+        {
+            peakDb = juce::jmax(newPeak, peakDb - static_cast<float>(peakFallDbPerSecond * elapsedSeconds));
+        }
+        
+        // RMS already averages over the frame, only a short release keeps it readable
+        rmsDb = newRms >= rmsDb ? newRms : juce::jmax(newRms, rmsDb - static_cast<float>(rmsFallDbPerSecond * elapsedSeconds));
+        
+        // under half a pixel of movement isn't worth a repaint
+        auto threshold = std::abs(minDb) / juce::jmax(1.f, 2.f * static_cast<float>(getHeight()));
+        
+        if ( std::abs(peakDb - paintedPeakDb) > threshold || std::abs(rmsDb - paintedRmsDb) > threshold )
+        {
+            paintedPeakDb = peakDb;
+            paintedRmsDb = rmsDb;
+            repaint();
+        }
+    }
+    
+    void paint(juce::Graphics& g) override
+    {
+        FrameBudget::Scope cost;
+        auto bounds = getLocalBounds().toFloat();
+        
+        g.setColour(juce::Colour(48u, 54u, 61u));
+        g.fillRect(bounds);
+        
+        auto yFor = [&bounds](float db) { return juce::jmap(db, minDb, 0.f, bounds.getBottom(), bounds.getY()); };
+        
+        g.setColour(juce::Colour(63u, 185u, 80u));
+        g.fillRect(bounds.withTop(yFor(paintedRmsDb)));
+        
+        g.setColour(paintedPeakDb > -0.1f ? juce::Colours::red : juce::Colours::white);
+        g.fillRect(bounds.withTop(yFor(paintedPeakDb)).withHeight(1.5f));
+    }
+    
+private:
+    static constexpr double peakHoldSeconds = 1.0;
+    static constexpr double peakFallDbPerSecond = 20.0;
+    static constexpr double rmsFallDbPerSecond = 40.0;
+    
+    float peakDb { minDb }, rmsDb { minDb };
+    float paintedPeakDb { minDb }, paintedRmsDb { minDb };
+    double holdSeconds { 0.0 };
+};
+
+// bar growing down from the top as the compressor reduces the gain
+struct GainReductionMeter : juce::Component
+{
+    static constexpr float maxDb = 24.f;
+    
+    GainReductionMeter() { setOpaque(true); }
+    
+    void update(float reductionDb, bool hasNewReduction, double elapsedSeconds)
+    {
+        auto target = hasNewReduction ? reductionDb : 0.f;
+        
+        // attack instantly, release like a needle would
+        shownDb = target >= shownDb ? target : juce::jmax(target, shownDb - static_cast<float>(releaseDbPerSecond * elapsedSeconds));
+        
+        auto threshold = maxDb / juce::jmax(1.f, 2.f * static_cast<float>(getHeight()));
+        
+        if ( std::abs(shownDb - paintedDb) > threshold )
+        {
+            paintedDb = shownDb;
+            repaint();
+        }
+    }
+    
+    void paint(juce::Graphics& g) override
+    {
+        FrameBudget::Scope cost;
+        auto bounds = getLocalBounds().toFloat();
+        
+        g.setColour(juce::Colour(48u, 54u, 61u));
+        g.fillRect(bounds);
+        
+        g.setColour(juce::Colour(210u, 153u, 34u));
+        g.fillRect(bounds.withHeight(bounds.getHeight() * juce::jlimit(0.f, 1.f, paintedDb / maxDb)));
+    }
+    
+private:
+    static constexpr double releaseDbPerSecond = 30.0;
+    
+    float shownDb { 0.f }, paintedDb { 0.f };
+};
@@ -0,0 +1,228 @@
+/*
+  ==============================================================================
+
+    Metering.h
+    Created: 17 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// peak and mean square of a signal over some stretch of blocks, all channels together
+struct MeterLevels
+{
+    float peak { 0.f };
+    float sumSquares { 0.f };
+    int numSamples { 0 };
+    
+    float getRMS() const { return numSamples > 0 ? std::sqrt(sumSquares / static_cast<float>(numSamples)) : 0.f; }
+    
+    void reset() { *this = {}; }
+    
+    void merge(const MeterLevels& other)
+    {
+        peak = juce::jmax(peak, other.peak);
+        sumSquares += other.sumSquares;
+        numSamples += other.numSamples;
+    }
+    
+    // one pass per channel: SIMD min/max for the peak, and four partial sums so the
+    // squares don't wait on each other - a plain float sum can't be vectorised
+    template<typename SampleType>
+    void measure(const juce::AudioBuffer<SampleType>& buffer, int numChannels, int start, int num)
+    {
+        for ( auto ch = 0; ch < numChannels; ++ch )
+        {
+            auto* x = buffer.getReadPointer(ch, start);
+            
+            auto range = juce::FloatVectorOperations::findMinAndMax(x, num);
+            peak = juce::jmax(peak, static_cast<float>(juce::jmax(-range.getStart(), range.getEnd())));
+            
+            SampleType s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+            auto i = 0;
+            
+            for ( ; i + 4 <= num; i += 4 )
+            {
+                s0 += x[i] * x[i];
+                s1 += x[i + 1] * x[i + 1];
+                s2 += x[i + 2] * x[i + 2];
+                s3 += x[i + 3] * x[i + 3];
+            }
+            
+            for ( ; i < num; ++i )
+                s0 += x[i] * x[i];
+            
+            sumSquares += static_cast<float>((s0 + s1) + (s2 + s3));
+        }
+        
+        numSamples += numChannels * num;
+    }
+};
+
+// everything the editor's meters show, summed over however many blocks ran since it last looked
+template<size_t NumBands>
+struct MeterFrame
+{
+    MeterLevels input, output;
+    
+    // each band after its compressor, before solo/mute
+    std::array<MeterLevels, NumBands> bands;
+    
+    // deepest reduction of each band in dB, 0 = none
+    std::array<float, NumBands> gainReduction {};
+    
+    void reset()
+    {
+        input.reset();
+        output.reset();
+        
+        for ( auto& band : bands )
+            band.reset();
+        
+        gainReduction.fill(0.f);
+    }
+    
+    void merge(const MeterFrame& other)
+    {
+        input.merge(other.input);
+        output.merge(other.output);
+        
+        for ( size_t i = 0; i < NumBands; ++i )
+        {
+            bands[i].merge(other.bands[i]);
+            gainReduction[i] = juce::jmax(gainReduction[i], other.gainReduction[i]);
+        }
+    }
+};
+
+/*
+    Mono feed for the spectrum analyzer, the audio thread pushes and one reader pulls.
+    AbstractFifo is lock-free for one of each. A reader that falls behind only costs
+    the samples that didn't fit, the audio thread never waits for it.
+*/
+struct AnalyzerFifo
+{
+    // a little over half a second at 48kHz, nothing is allocated after construction
+    static constexpr int capacity = 1 << 15;
+    
+    // audio thread, the first numChannels of buffer averaged down to one channel
+    template<typename SampleType>
+    void push(const juce::AudioBuffer<SampleType>& buffer, int numChannels, int start, int num)
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite(num, start1, size1, start2, size2);
+        
+        mixDown(buffer, numChannels, start, samples.data() + start1, size1);
+        mixDown(buffer, numChannels, start + size1, samples.data() + start2, size2);
+        
+        fifo.finishedWrite(size1 + size2);
+    }
+    
+    // reader only
+    int getNumReady() const { return fifo.getNumReady(); }
+    
+    // reader only, the oldest num samples, num must not be more than getNumReady()
+    void pull(float* dest, int num)
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(num, start1, size1, start2, size2);
+        
+        std::copy_n(samples.data() + start1, size1, dest);
+        std::copy_n(samples.data() + start2, size2, dest + size1);
+        
+        fifo.finishedRead(size1 + size2);
+    }
+    
+    // reader only, drops whatever was left from before it started listening
+    void discard() { fifo.finishedRead(fifo.getNumReady()); }
+    
+private:
+    template<typename SampleType>
+    static void mixDown(const juce::AudioBuffer<SampleType>& buffer, int numChannels, int start, float* dest, int num)
+    {
+        if ( num <= 0 )
+            return;
+        
+        auto gain = SampleType(1) / static_cast<SampleType>(juce::jmax(1, numChannels));
+        
+        auto* x = buffer.getReadPointer(0, start);
+        for ( auto i = 0; i < num; ++i )
+            dest[i] = static_cast<float>(x[i] * gain);
+        
+        for ( auto ch = 1; ch < numChannels; ++ch )
+        {
+            x = buffer.getReadPointer(ch, start);
+            for ( auto i = 0; i < num; ++i )
+                dest[i] += static_cast<float>(x[i] * gain);
+        }
+    }
+    
+    juce::AbstractFifo fifo { capacity };
+    std::vector<float> samples = std::vector<float>(static_cast<size_t>(capacity));
+};
+
+/*
+    Wait-free single producer, single consumer hand over of the latest T, a triple buffer.
+
+    The writer fills getWriteSlot() and publish() swaps it with the middle slot, the
+    reader's read() swaps the middle slot with its own whenever there is a new one.
+    Neither side ever waits or sees a slot the other one is using.
+
+    A published T the reader hasn't picked up yet can be taken back with reclaim() and
+    added to before publishing again - a writer that does that, rather than replacing
+    it, doesn't lose anything between two reads (peaks between two repaints, say).
+*/
+template<typename T>
+struct SnapshotChannel
+{
+    // writer only
+    T& getWriteSlot() { return slots[writeIndex]; }
+    
+    // writer only
+    void publish()
+    {
+        writeIndex = middle.exchange(writeIndex | freshFlag, std::memory_order_acq_rel) & indexMask;
+    }
+    
+    // writer only, true if the last published T was still unread and getWriteSlot() now
+    // holds it. False if the reader has it, or takes it while this runs - the write slot
+    // then holds something the reader already had, to be overwritten
+    bool reclaim()
+    {
+        auto current = middle.load(std::memory_order_acquire);
+        
+        if ( (current & freshFlag) == 0 || !middle.compare_exchange_strong(current, writeIndex, std::memory_order_acq_rel) )
+            return false;
+        
+        writeIndex = current & indexMask;
+        return true;
+    }
+    
+    // reader only, false if nothing was published since the last read
+    bool read(T& dest)
+    {
+        if ( (middle.load(std::memory_order_relaxed) & freshFlag) == 0 )
+            return false;
+        
+        // reclaim() may have taken it back since the check, the slot swapped in is stale then
+        auto previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & indexMask;
+        
+        if ( (previous & freshFlag) == 0 )
+            return false;
+        
+        dest = slots[readIndex];
+        return true;
+    }
+    
+private:
+    static constexpr int freshFlag = 4;
+    static constexpr int indexMask = 3;
+    
+    std::array<T, 3> slots {};
+    int writeIndex { 0 }, readIndex { 1 };
+    std::atomic<int> middle { 2 };
+};
@@ -13,78 +13,99 @@
 MBCompTutorialAudioProcessorEditor::MBCompTutorialAudioProcessorEditor (MBCompTutorialAudioProcessor& p)
     : AudioProcessorEditor (&p), audioProcessor (p),
       gainInput_Attachment(audioProcessor.apvts, "Gain In", gainInput),
-      gainOutput_Attachment(audioProcessor.apvts, "Gain Out", gainOutput),
-      crossoverLowMid_Attachment(audioProcessor.apvts, "Low-Mid Crossover Frequency", crossoverLowMid),
-      crossoverMidHigh_Attachment(audioProcessor.apvts, "Mid-High Crossover Frequency", crossoverMidHigh)
+      gainOutput_Attachment(audioProcessor.apvts, "Gain Out", gainOutput)
 {
-    addSlider(crossoverLowMid, crossoverLowMid_Label, "Low-Mid X-Over");
-    addSlider(crossoverMidHigh, crossoverMidHigh_Label, "Mid-High X-Over");
+    for ( size_t i = 0; i < Params::numCrossovers; ++i )
+    {
+        crossover_Attachments.add(new sliderAttachment(audioProcessor.apvts, Params::getCrossoverParamName(i), crossovers[i]));
+        addSlider(crossovers[i], crossover_Labels[i], Params::getBandName(i) + "-" + Params::getBandName(i + 1) + " X-Over");
+    }
     
     addSlider(gainInput, gainInput_Label, "Gain In");
     addSlider(gainOutput, gainOutput_Label, "Gain Out");
     
-    addAndMakeVisible(lowBand);
-    addAndMakeVisible(midBand);
-    addAndMakeVisible(highBand);
+    for ( size_t i = 0; i < Params::numBands; ++i )
+        addAndMakeVisible(bands.add(new Band(audioProcessor, i)));
     
-    setSize (600, 450);
+    addAndMakeVisible(inputMeter);
+    addAndMakeVisible(outputMeter);
+    addAndMakeVisible(spectrum);
+    
+    audioProcessor.setMeteringActive(true);
+    
+    // only the gaps between the bands, meters and analyzer ever show the editor's own paint
+    setOpaque(true);
+    
+    setSize (640, analyzerHeight + bandHeight * static_cast<int>(Params::numBands));
 }
 
 MBCompTutorialAudioProcessorEditor::~MBCompTutorialAudioProcessorEditor()
 {
+    audioProcessor.setMeteringActive(false);
 }
 
-//==============================================================================
-void MBCompTutorialAudioProcessorEditor::paint (juce::Graphics& g)
+void MBCompTutorialAudioProcessorEditor::updateMeters(double elapsedSeconds)
 {
-    auto bounds = getLocalBounds();
+    // no new block since the last refresh (transport stopped, or a slow host) lets the meters fall
+    auto hasNewMeters = audioProcessor.readMeters(meters);
     
-    auto grey = juce::Colour(48u, 54u, 61u);
-    auto navy = juce::Colour(13u, 17u, 23u);
+    inputMeter.update(meters.input, hasNewMeters, elapsedSeconds);
+    outputMeter.update(meters.output, hasNewMeters, elapsedSeconds);
     
-    g.setColour(grey); // grey for border
-    g.fillAll();
+    for ( size_t i = 0; i < Params::numBands; ++i )
+    {
+        bands[static_cast<int>(i)]->levelMeter.update(meters.bands[i], hasNewMeters, elapsedSeconds);
+        bands[static_cast<int>(i)]->gainReductionMeter.update(meters.gainReduction[i], hasNewMeters, elapsedSeconds);
+    }
     
-    bounds.reduce(3, 2);
-    g.setColour(navy); // navy for fill
-    g.fillRoundedRectangle(bounds.toFloat(), 3);
+    spectrum.refresh();
+}
+
+//==============================================================================
+void MBCompTutorialAudioProcessorEditor::paint (juce::Graphics& g)
+{
+    background.draw(g, getLocalBounds(), drawPanelBackground);
 }
 
 void MBCompTutorialAudioProcessorEditor::resized()
 {
     auto bounds = getLocalBounds();
+    
+    spectrum.setBounds(bounds.removeFromTop(analyzerHeight).reduced(6, 6));
+    
+    auto ioMeters = bounds.removeFromRight(40).reduced(6, 30);
+    inputMeter.setBounds(ioMeters.removeFromLeft(ioMeters.getWidth() / 2).withTrimmedRight(2));
+    outputMeter.setBounds(ioMeters.withTrimmedLeft(2));
+    
     auto rightStrip = bounds.removeFromRight(150);
     
-    lowBand.setBounds(bounds.removeFromTop(150));
-    midBand.setBounds(bounds.removeFromTop(150));
-    highBand.setBounds(bounds);
+    for ( auto* band : bands )
+        band->setBounds(bounds.removeFromTop(bandHeight));
 
     // Crossover / IO Gain
     using Track = juce::Grid::TrackInfo;
     using Fr = juce::Grid::Fr;
     
     juce::Grid xOverIO;
-    xOverIO.templateRows = { Track(Fr (1)), Track(Fr (1)), Track(Fr (1)), Track(Fr (1)) };
     xOverIO.templateColumns = { Track(Fr (1)) };
     
-    auto lmXOver = juce::GridItem(crossoverLowMid);
-    auto mhXOver = juce::GridItem(crossoverMidHigh);
-    auto inGain = juce::GridItem(gainInput);
-    auto outGain = juce::GridItem(gainOutput);
-    
     auto mrg = juce::GridItem::Margin(30.f, 0.f, 10.f, 0.f);
-    lmXOver.margin = mrg;
-    mhXOver.margin = mrg;
-    inGain.margin = mrg;
-    outGain.margin = mrg;
-    
-    xOverIO.items = {
-        juce::GridItem(lmXOver),
-        juce::GridItem(mhXOver),
-        juce::GridItem(inGain),
-        juce::GridItem(outGain)
+    
+    auto addRow = [&xOverIO, mrg](juce::Slider& slider)
+    {
+        auto item = juce::GridItem(slider);
+        item.margin = mrg;
+        
+        xOverIO.templateRows.add(Track(Fr (1)));
+        xOverIO.items.add(item);
     };
     
+    for ( auto& xOver : crossovers )
+        addRow(xOver);
+    
+    addRow(gainInput);
+    addRow(gainOutput);
+    
     xOverIO.performLayout(rightStrip);
 }
 
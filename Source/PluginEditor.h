@@ -11,6 +11,7 @@
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
 #include "Band.h"
+#include "Analyzer.h"
 
 //==============================================================================
 /**
@@ -26,28 +27,45 @@ public:
     void resized() override;
     
     void addSlider(juce::Slider& slider, juce::Label& label, const juce::String& labelText);
+    
+    // latest levels from the processor into every meter and the analyzer, once per refresh
+    void updateMeters(double elapsedSeconds);
 
 private:
+    static constexpr int bandHeight = 150;
+    static constexpr int analyzerHeight = 180;
+    
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     MBCompTutorialAudioProcessor& audioProcessor;
     
-    Band lowBand{ audioProcessor, "Low" };
-    Band midBand{ audioProcessor, "Mid" };
-    Band highBand{ audioProcessor, "High" };
+    // lowest band first
+    juce::OwnedArray<Band> bands;
     
     juce::Slider gainInput, gainOutput;
     
     juce::Label gainInput_Label, gainOutput_Label;
     
-    juce::Slider crossoverLowMid, crossoverMidHigh;
+    // lowest crossover first
+    std::array<juce::Slider, Params::numCrossovers> crossovers;
     
-    juce::Label crossoverLowMid_Label, crossoverMidHigh_Label;
+    std::array<juce::Label, Params::numCrossovers> crossover_Labels;
     
     using sliderAttachment = juce::AudioProcessorValueTreeState::SliderAttachment;
     
-    sliderAttachment gainInput_Attachment, gainOutput_Attachment,
-                     crossoverLowMid_Attachment, crossoverMidHigh_Attachment;
+    sliderAttachment gainInput_Attachment, gainOutput_Attachment;
+    
+    juce::OwnedArray<sliderAttachment> crossover_Attachments;
+    
+    LevelMeter inputMeter, outputMeter;
+    MBCompTutorialAudioProcessor::Meters meters;
+    
+    SpectrumDisplay spectrum { audioProcessor };
+    
+    CachedBackground background;
+    
+    // last, so it stops before any meter it feeds goes away
+    MeterRefresh meterRefresh { this, [this](double elapsed) { updateMeters(elapsed); } };
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MBCompTutorialAudioProcessorEditor)
 };
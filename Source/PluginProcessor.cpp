@@ -16,6 +16,7 @@ MBCompTutorialAudioProcessor::MBCompTutorialAudioProcessor()
                      #if ! JucePlugin_IsMidiEffect
                       #if ! JucePlugin_IsSynth
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                       .withInput  ("Sidechain", juce::AudioChannelSet::stereo(), false)
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
@@ -28,63 +29,143 @@ MBCompTutorialAudioProcessor::MBCompTutorialAudioProcessor()
     // jassert as safety check - will also catch if cast fails
     const auto& params = Params::getParams();
     
-    auto floatHelper = [&apvts = this->apvts, &params](auto& param, const auto& paramName)
+    auto floatHelper = [&apvts = this->apvts](auto& param, const juce::String& paramName)
     {
-        param = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter(params.at(paramName)));
+        param = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter(paramName));
         jassert(param != nullptr);
     };
     
-    auto choiceHelper = [&apvts = this->apvts, &params](auto& param, const auto& paramName)
+    auto choiceHelper = [&apvts = this->apvts](auto& param, const juce::String& paramName)
     {
-        param = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter(params.at(paramName)));
+        param = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter(paramName));
         jassert(param != nullptr);
     };
     
-    auto boolHelper = [&apvts = this->apvts, &params](auto& param, const auto& paramName)
+    auto boolHelper = [&apvts = this->apvts](auto& param, const juce::String& paramName)
     {
-        param = dynamic_cast<juce::AudioParameterBool*>(apvts.getParameter(params.at(paramName)));
+        param = dynamic_cast<juce::AudioParameterBool*>(apvts.getParameter(paramName));
         jassert(param != nullptr);
     };
     
-    floatHelper(lowBandComp.threshold, Params::Names::Threshold_Low_Band);
-    floatHelper(lowBandComp.attack, Params::Names::Attack_Low_Band);
-    floatHelper(lowBandComp.release, Params::Names::Release_Low_Band);
-    choiceHelper(lowBandComp.ratio, Params::Names::Ratio_Low_Band);
-    boolHelper(lowBandComp.bypass, Params::Names::Bypass_Low_Band);
-    boolHelper(lowBandComp.mute, Params::Names::Mute_Low_Band);
-    boolHelper(lowBandComp.solo, Params::Names::Solo_Low_Band);
-    
-    floatHelper(midBandComp.threshold, Params::Names::Threshold_Mid_Band);
-    floatHelper(midBandComp.attack, Params::Names::Attack_Mid_Band);
-    floatHelper(midBandComp.release, Params::Names::Release_Mid_Band);
-    choiceHelper(midBandComp.ratio, Params::Names::Ratio_Mid_Band);
-    boolHelper(midBandComp.bypass, Params::Names::Bypass_Mid_Band);
-    boolHelper(midBandComp.mute, Params::Names::Mute_Mid_Band);
-    boolHelper(midBandComp.solo, Params::Names::Solo_Mid_Band);
-    
-    floatHelper(highBandComp.threshold, Params::Names::Threshold_High_Band);
-    floatHelper(highBandComp.attack, Params::Names::Attack_High_Band);
-    floatHelper(highBandComp.release, Params::Names::Release_High_Band);
-    choiceHelper(highBandComp.ratio, Params::Names::Ratio_High_Band);
-    boolHelper(highBandComp.bypass, Params::Names::Bypass_High_Band);
-    boolHelper(highBandComp.mute, Params::Names::Mute_High_Band);
-    boolHelper(highBandComp.solo, Params::Names::Solo_High_Band);
-    
-    floatHelper(lowMidCrossover, Params::Names::Low_Mid_Crossover_Freq);
-    floatHelper(midHighCrossover, Params::Names::Mid_High_Crossover_Freq);
-    
-    floatHelper(inputGainParam, Params::Names::Gain_In);
-    floatHelper(outputGainParam, Params::Names::Gain_Out);
-    
-    LP1.setType(juce::dsp::LinkwitzRileyFilterType::lowpass);
-    HP1.setType(juce::dsp::LinkwitzRileyFilterType::highpass);
-    AP2.setType(juce::dsp::LinkwitzRileyFilterType::allpass);
-    LP2.setType(juce::dsp::LinkwitzRileyFilterType::lowpass);
-    HP2.setType(juce::dsp::LinkwitzRileyFilterType::highpass);
+    // the float and double engines' bands share the same params
+    auto bandHelper = [&](auto& bands)
+    {
+        for ( size_t i = 0; i < numBands; ++i )
+        {
+            auto& comp = bands[i];
+            
+            floatHelper(comp.threshold, Params::getBandParamName(Params::Threshold, i));
+            floatHelper(comp.attack, Params::getBandParamName(Params::Attack, i));
+            floatHelper(comp.release, Params::getBandParamName(Params::Release, i));
+            choiceHelper(comp.ratio, Params::getBandParamName(Params::Ratio, i));
+            floatHelper(comp.knee, Params::getBandParamName(Params::Knee, i));
+            choiceHelper(comp.detector, Params::getBandParamName(Params::Detector, i));
+            floatHelper(comp.lookahead, Params::getBandParamName(Params::Lookahead, i));
+            choiceHelper(comp.oversampling, Params::getBandParamName(Params::Oversampling, i));
+            boolHelper(comp.bypass, Params::getBandParamName(Params::Bypass, i));
+            boolHelper(comp.mute, Params::getBandParamName(Params::Mute, i));
+            boolHelper(comp.solo, Params::getBandParamName(Params::Solo, i));
+        }
+    };
+    
+    bandHelper(floatEngine.compressors);
+    bandHelper(doubleEngine.compressors);
+    
+    for ( size_t i = 0; i < Params::numCrossovers; ++i )
+        floatHelper(crossoverFreqs[i], Params::getCrossoverParamName(i));
+    
+    floatHelper(inputGainParam, params.at(Params::Names::Gain_In));
+    floatHelper(outputGainParam, params.at(Params::Names::Gain_Out));
+    choiceHelper(crossoverModeParam, params.at(Params::Names::Crossover_Mode));
+    boolHelper(parallelParam, params.at(Params::Names::Parallel_Processing));
+    choiceHelper(channelLinkParam, params.at(Params::Names::Channel_Link));
+    choiceHelper(linkModeParam, params.at(Params::Names::Link_Mode));
+    boolHelper(externalSidechainParam, params.at(Params::Names::External_Sidechain));
+    
+    // only the params that feed coefficient/settings recalculation are watched,
+    // bypass/mute/solo are read directly each block
+    dirtyBitForParam.resize(static_cast<size_t>(getParameters().size()), 0);
+    
+    for ( size_t i = 0; i < numBands; ++i )
+    {
+        auto& comp = floatEngine.compressors[i];
+        auto bit = Dirty_Band_0 << i;
+        
+        watchParam(comp.threshold, bit);
+        watchParam(comp.attack, bit);
+        watchParam(comp.release, bit);
+        watchParam(comp.ratio, bit);
+        watchParam(comp.knee, bit);
+        watchParam(comp.detector, bit);
+        watchParam(comp.lookahead, bit);
+        watchParam(comp.oversampling, bit);
+    }
+    
+    for ( size_t i = 0; i < Params::numCrossovers; ++i )
+        watchParam(crossoverFreqs[i], Dirty_Crossover_0 << i);
+    
+    watchParam(inputGainParam, Dirty_Gain_In);
+    watchParam(outputGainParam, Dirty_Gain_Out);
+    watchParam(crossoverModeParam, Dirty_Crossover_Mode);
+    watchParam(channelLinkParam, Dirty_Channel_Link);
+    watchParam(linkModeParam, Dirty_Channel_Link);
+    
+    startTimerHz(20);
 }
 
 MBCompTutorialAudioProcessor::~MBCompTutorialAudioProcessor()
 {
+    stopTimer();
+    
+    for ( auto* param : getParameters() )
+        param->removeListener(this);
+}
+
+void MBCompTutorialAudioProcessor::watchParam(juce::AudioProcessorParameter* param, uint32_t dirtyBit)
+{
+    auto index = static_cast<size_t>(param->getParameterIndex());
+    jassert(index < dirtyBitForParam.size());
+    
+    dirtyBitForParam[index] |= dirtyBit;
+    param->addListener(this);
+}
+
+void MBCompTutorialAudioProcessor::parameterValueChanged(int parameterIndex, float)
+{
+    // can be called from any thread, including the audio thread during automation
+    dirtyParams.fetch_or(dirtyBitForParam[static_cast<size_t>(parameterIndex)], std::memory_order_release);
+}
+
+void MBCompTutorialAudioProcessor::parameterGestureChanged(int, bool)
+{
+}
+
+void MBCompTutorialAudioProcessor::timerCallback()
+{
+    auto latency = pendingLatency.load(std::memory_order_relaxed);
+    
+    if ( latency != getLatencySamples() )
+        setLatencySamples(latency);
+    
+    // the FIR kernel builder only runs while linear phase is selected
+    linearPhaseCrossover.setActive(crossoverModeParam->getIndex() == 1);
+    linearPhaseCrossover.notifyBuilder();
+    
+    updateWorkerPool();
+}
+
+void MBCompTutorialAudioProcessor::updateWorkerPool()
+{
+    auto wanted = prepared && parallelParam->get();
+    
+    if ( wanted == workerPool.isRunning() )
+        return;
+    
+    // the calling thread takes one band itself
+    if ( wanted )
+        workerPool.start(static_cast<int>(numBands) - 1);
+    else
+        workerPool.stop();
 }
 
 //==============================================================================
@@ -122,7 +203,7 @@ bool MBCompTutorialAudioProcessor::isMidiEffect() const
 
 double MBCompTutorialAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    return tailSeconds.load(std::memory_order_relaxed);
 }
 
 int MBCompTutorialAudioProcessor::getNumPrograms()
@@ -155,34 +236,121 @@ void MBCompTutorialAudioProcessor::prepareToPlay (double sampleRate, int samples
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
     
+    // room for a whole host block, which the parallel path hands to the workers in one go.
+    // The serial path only ever uses the first subBlockSize samples of it
     juce::dsp::ProcessSpec spec;
     spec.sampleRate = sampleRate;
-    spec.maximumBlockSize = samplesPerBlock;
+    spec.maximumBlockSize = static_cast<juce::uint32>(juce::jmax(1, samplesPerBlock));
+    preparedBlockSize = static_cast<int>(spec.maximumBlockSize);
+    preparedSampleRate = sampleRate;
     spec.numChannels = getTotalNumOutputChannels();
     
-    for ( auto& compressor : compressors )
-        compressor.prepare(spec);
+    numSidechainChannels = getBusCount(true) > 1 ? getChannelCountOfBus(true, 1) : 0;
+    
+    buildChannelGroups(getChannelLayoutOfBus(false, 0));
+    
+    // the host picks the precision before preparing, only that engine gets any memory
+    if ( isUsingDoublePrecision() )
+        prepareEngine<double>(spec);
+    else
+        prepareEngine<float>(spec);
+    
+    outputGain.reset(sampleRate, 0.05);
+    outputGain.setCurrentAndTargetValue(juce::Decibels::decibelsToGain(outputGainParam->get()));
     
-    LP1.prepare(spec);
-    HP1.prepare(spec);
-    AP2.prepare(spec);
-    LP2.prepare(spec);
-    HP2.prepare(spec);
+    prepared = true;
+    updateWorkerPool();
     
-    inputGain.prepare(spec);
-    outputGain.prepare(spec);
+   #if MBCOMP_ENABLE_PROFILING
+    {
+        juce::StringArray stages { "Input Gain", "Split", "Sum + Output Gain" };
+        juce::StringArray tracks { "Chain" };
+        
+        for ( size_t i = 0; i < numBands; ++i )
+        {
+            stages.add("Band " + juce::String(i));
+            tracks.add("Band " + juce::String(i));
+        }
+        
+        if ( traceFile == juce::File() )
+            traceFile = juce::File::getSpecialLocation(juce::File::tempDirectory).getNonexistentChildFile("MBCompTutorial Trace", ".json", false);
+        
+        profiler.start(traceFile, stages, tracks);
+    }
+   #endif
     
-    inputGain.setRampDurationSeconds(0.05);
-    outputGain.setRampDurationSeconds(0.05);
+    // start each band at its current solo/mute state rather than fading in
+    for ( auto& gain : bandGains )
+        gain.reset(sampleRate, 0.01);
     
-    for ( auto& buffer : filterBuffers )
-        buffer.setSize(spec.numChannels, spec.maximumBlockSize);
+    planBands();
+    
+    for ( auto& gain : bandGains )
+        gain.setCurrentAndTargetValue(gain.getTargetValue());
+    
+    // freshly prepared dsp is silent already, but not asleep until the input has been
+    silentSamples = 0;
+    sleeping = false;
+    
+    // freshly prepared dsp picks up every current value on the first block
+    dirtyParams.store(Dirty_All);
+}
+
+template<typename SampleType>
+void MBCompTutorialAudioProcessor::prepareEngine(const juce::dsp::ProcessSpec& spec)
+{
+    auto& engine = getEngine<SampleType>();
+    
+    for ( auto& compressor : engine.compressors )
+    {
+        compressor.prepare(spec, numSidechainChannels);
+        compressor.updateCompressorSettings();
+    }
+    
+    // the sidechain is split by the same crossovers, as extra channels after the main ones
+    auto splitSpec = spec;
+    splitSpec.numChannels += static_cast<juce::uint32>(numSidechainChannels);
+    
+    // the IIR tree starts at the frequencies set before prepare, rather than gliding in
+    for ( size_t i = 0; i < Params::numCrossovers; ++i )
+        engine.crossover.setCrossoverFrequency(i, crossoverFreqs[i]->get());
+    
+    engine.crossover.prepare(splitSpec);
+    
+    // kernels for the current frequencies are built during prepare, if linear phase is selected
+    for ( size_t i = 0; i < Params::numCrossovers; ++i )
+        linearPhaseCrossover.setCrossoverFrequency(i, crossoverFreqs[i]->get());
+    
+    linearPhase = crossoverModeParam->getIndex() == 1;
+    linearPhaseCrossover.setActive(linearPhase);
+    linearPhaseCrossover.prepare(splitSpec);
+    
+    // the host reads the latency after prepareToPlay, so it has to be right already
+    updateLatency<SampleType>();
+    setLatencySamples(pendingLatency.load());
+    
+    // and the tail
+    updateTail<SampleType>();
+    
+    engine.inputGain.prepare(spec);
+    engine.inputGain.setRampDurationSeconds(0.05);
+    
+    for ( auto& buffer : engine.filterBuffers )
+        buffer.setSize(static_cast<int>(splitSpec.numChannels), static_cast<int>(spec.maximumBlockSize));
+    
+    engine.bandWeights.setSize(static_cast<int>(numBands), static_cast<int>(spec.maximumBlockSize));
 }
 
 void MBCompTutorialAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    prepared = false;
+    updateWorkerPool();
+    
+   #if MBCOMP_ENABLE_PROFILING
+    profiler.stop();
+   #endif
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -192,18 +360,25 @@ bool MBCompTutorialAudioProcessor::isBusesLayoutSupported (const BusesLayout& la
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // any layout the dsp has room for - mono, stereo, surround, ambisonic or discrete.
+    // Channels are split and compressed in SIMD batches, so no layout is special
+    auto numChannels = layouts.getMainOutputChannelSet().size();
+    if (numChannels < 1 || numChannels > maxChannels)
         return false;
 
     // This checks if the input layout matches the output layout
    #if ! JucePlugin_IsSynth
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
+    
+    // the sidechain keys every channel from mono, or channel by channel
+    if (layouts.inputBuses.size() > 1)
+    {
+        auto sidechain = layouts.getChannelSet(true, 1);
+        
+        if (! sidechain.isDisabled() && sidechain.size() != 1 && sidechain.size() != numChannels)
+            return false;
+    }
    #endif
 
     return true;
@@ -211,48 +386,370 @@ bool MBCompTutorialAudioProcessor::isBusesLayoutSupported (const BusesLayout& la
 }
 #endif
 
+template<typename SampleType>
 void MBCompTutorialAudioProcessor::updateState()
 {
-    for ( auto& compressor : compressors)
-        compressor.updateCompressorSettings();
+    auto& engine = getEngine<SampleType>();
+    
+    // nothing moved since the last block - nothing to recompute
+    auto dirty = dirtyParams.exchange(0, std::memory_order_acquire);
+    if ( dirty == 0 )
+        return;
+    
+    for ( size_t i = 0; i < numBands; ++i )
+    {
+        if ( dirty & (Dirty_Band_0 << i) )
+            engine.compressors[i].updateCompressorSettings();
+    }
     
-    inputGain.setGainDecibels(inputGainParam->get());
-    outputGain.setGainDecibels(outputGainParam->get());
+    if ( dirty & (Dirty_Band_0 * ((1u << numBands) - 1)) )
+        updateLatency<SampleType>();
     
-    auto lowMidCutoff = lowMidCrossover->get();
-    LP1.setCutoffFrequency(lowMidCutoff);
-    HP1.setCutoffFrequency(lowMidCutoff);
+    if ( dirty & Dirty_Gain_In )
+        engine.inputGain.setGainDecibels(inputGainParam->get());
     
-    auto midHighCutoff = midHighCrossover->get();
-    AP2.setCutoffFrequency(midHighCutoff);
-    LP2.setCutoffFrequency(midHighCutoff);
-    HP2.setCutoffFrequency(midHighCutoff);
+    if ( dirty & Dirty_Gain_Out )
+        outputGain.setTargetValue(juce::Decibels::decibelsToGain(outputGainParam->get()));
+    
+    for ( size_t i = 0; i < Params::numCrossovers; ++i )
+    {
+        if ( dirty & (Dirty_Crossover_0 << i) )
+        {
+            engine.crossover.setCrossoverFrequency(i, crossoverFreqs[i]->get());
+            linearPhaseCrossover.setCrossoverFrequency(i, crossoverFreqs[i]->get());
+        }
+    }
+    
+    if ( dirty & Dirty_Channel_Link )
+    {
+        const auto& groups = channelGroups[static_cast<size_t>(channelLinkParam->getIndex())];
+        auto link = static_cast<CompressorBase::Link>(linkModeParam->getIndex());
+        
+        for ( auto& comp : engine.compressors )
+            comp.setChannelLink(groups, link);
+    }
+    
+    if ( dirty & Dirty_Crossover_Mode )
+    {
+        auto newMode = crossoverModeParam->getIndex() == 1;
+        
+        // the kernels are only built once linear phase is selected, the IIR tree
+        // carries on until they're ready and the switch is retried every block
+        if ( newMode && !linearPhaseCrossover.hasKernels() )
+        {
+            newMode = false;
+            dirtyParams.fetch_or(Dirty_Crossover_Mode, std::memory_order_relaxed);
+        }
+        
+        // the idle crossover hasn't seen any input, start it from silence
+        if ( newMode != linearPhase )
+        {
+            linearPhase = newMode;
+            
+            if ( linearPhase )
+                linearPhaseCrossover.reset();
+            else
+                engine.crossover.reset();
+            
+            updateLatency<SampleType>();
+        }
+    }
+    
+    updateTail<SampleType>();
 }
 
-void MBCompTutorialAudioProcessor::splitBands(const juce::AudioBuffer<float> &inputBuffer)
+template<typename SampleType>
+void MBCompTutorialAudioProcessor::updateLatency()
 {
-    for ( auto& fb : filterBuffers )
-        fb = inputBuffer;
+    auto& compressors = getEngine<SampleType>().compressors;
+    
+    auto bandLatency = 0;
+    for ( const auto& comp : compressors )
+        bandLatency = juce::jmax(bandLatency, comp.getLatencySamples());
+    
+    // no allocation here, the compressors only move their read positions
+    for ( auto& comp : compressors )
+        comp.setLatency(bandLatency);
+    
+    pendingLatency.store(bandLatency + (linearPhase ? linearPhaseCrossover.getLatencySamples() : 0), std::memory_order_relaxed);
+}
+
+template<typename SampleType>
+void MBCompTutorialAudioProcessor::updateTail()
+{
+    auto& engine = getEngine<SampleType>();
+    
+    // not getSampleRate(), which stays 0 unless the host also called setPlayConfigDetails
+    auto sampleRate = preparedSampleRate;
+    
+    if ( sampleRate <= 0.0 )
+        return;
+    
+    auto release = 0.0;
+    for ( const auto& comp : engine.compressors )
+        release = juce::jmax(release, comp.getTailSeconds());
     
-    auto fb0Block = juce::dsp::AudioBlock<float>(filterBuffers[0]);
-    auto fb1Block = juce::dsp::AudioBlock<float>(filterBuffers[1]);
-    auto fb2Block = juce::dsp::AudioBlock<float>(filterBuffers[2]);
+    // the linear phase and oversampling FIRs are symmetric, twice the latency covers their whole length
+    auto seconds = release + 2.0 * pendingLatency.load(std::memory_order_relaxed) / sampleRate;
     
-    auto fb0Ctx = juce::dsp::ProcessContextReplacing<float>(fb0Block);
-    auto fb1Ctx = juce::dsp::ProcessContextReplacing<float>(fb1Block);
-    auto fb2Ctx = juce::dsp::ProcessContextReplacing<float>(fb2Block);
+    if ( !linearPhase )
+        seconds += engine.crossover.getTailSeconds(silenceDb);
+    
+    tailSamples = static_cast<int>(std::ceil(seconds * sampleRate));
+    tailSeconds.store(seconds, std::memory_order_relaxed);
+}
+
+template<typename SampleType>
+void MBCompTutorialAudioProcessor::resetDsp()
+{
+    auto& engine = getEngine<SampleType>();
     
-    LP1.process(fb0Ctx);
-    AP2.process(fb0Ctx);
+    for ( auto& comp : engine.compressors )
+        comp.reset();
     
-    HP1.process(fb1Ctx);
-    filterBuffers[2] = filterBuffers[1];
-    LP2.process(fb1Ctx);
+    if ( linearPhase )
+        linearPhaseCrossover.reset();
+    else
+        engine.crossover.reset();
+}
+
+template<typename SampleType>
+bool MBCompTutorialAudioProcessor::isSilent(const juce::AudioBuffer<SampleType>& buffer, int numChannels) const
+{
+    // bails out on the first audible sample, so it costs next to nothing while there's signal
+    for ( auto ch = 0; ch < numChannels; ++ch )
+    {
+        auto* x = buffer.getReadPointer(ch);
+        
+        for ( auto i = 0; i < buffer.getNumSamples(); ++i )
+        {
+            if ( std::abs(x[i]) > static_cast<SampleType>(silenceThreshold) )
+                return false;
+        }
+    }
     
-    HP2.process(fb2Ctx);
+    return true;
+}
+
+void MBCompTutorialAudioProcessor::buildChannelGroups(const juce::AudioChannelSet& layout)
+{
+    auto numChannels = getTotalNumOutputChannels();
+    
+    // surround linking: fronts, surrounds, tops and LFEs each share a detector,
+    // so a loud centre pumps the fronts but leaves the rears alone
+    auto surroundGroup = [](juce::AudioChannelSet::ChannelType type)
+    {
+        using CS = juce::AudioChannelSet;
+        
+        switch ( type )
+        {
+            case CS::LFE:
+            case CS::LFE2:
+                return 3;
+                
+            case CS::leftSurround:
+            case CS::rightSurround:
+            case CS::centreSurround:
+            case CS::leftSurroundSide:
+            case CS::rightSurroundSide:
+            case CS::leftSurroundRear:
+            case CS::rightSurroundRear:
+                return 1;
+                
+            case CS::topMiddle:
+            case CS::topFrontLeft:
+            case CS::topFrontCentre:
+            case CS::topFrontRight:
+            case CS::topRearLeft:
+            case CS::topRearCentre:
+            case CS::topRearRight:
+            case CS::topSideLeft:
+            case CS::topSideRight:
+                return 2;
+                
+            default:
+                return 0;
+        }
+    };
+    
+    // ambisonic components and unnamed channels have no front/rear to go by
+    auto positional = !layout.isDiscreteLayout() && layout.getAmbisonicOrder() < 0 && layout.size() == numChannels;
+    
+    for ( auto& groups : channelGroups )
+        groups.resize(static_cast<size_t>(numChannels));
+    
+    // groups numbered in order of first use, the compressor wants them packed from 0
+    std::array<int, 4> surroundIndex;
+    surroundIndex.fill(-1);
+    auto numSurroundGroups = 0;
+    
+    for ( auto ch = 0; ch < numChannels; ++ch )
+    {
+        auto i = static_cast<size_t>(ch);
+        
+        channelGroups[Params::Link_Off][i] = ch;
+        channelGroups[Params::Link_Pairs][i] = ch / 2;
+        channelGroups[Params::Link_All][i] = 0;
+        
+        auto& surround = surroundIndex[static_cast<size_t>(positional ? surroundGroup(layout.getTypeOfChannel(ch)) : 0)];
+        if ( surround < 0 )
+            surround = numSurroundGroups++;
+        
+        channelGroups[Params::Link_Surround][i] = surround;
+    }
+}
+
+void MBCompTutorialAudioProcessor::planBands()
+{
+    // solo/mute/bypass are the same params in both engines
+    const auto& compressors = floatEngine.compressors;
+    
+    auto bandSolod = std::any_of(compressors.begin(), compressors.end(), [](const auto& comp) { return comp.solo->get(); });
+    
+    for ( size_t i = 0; i < numBands; ++i )
+    {
+        auto& comp = compressors[i];
+        auto audible = bandSolod ? comp.solo->get() : !comp.mute->get();
+        
+        bandGains[i].setTargetValue(audible ? 1.f : 0.f);
+        bandActive[i] = audible || bandGains[i].isSmoothing();
+    }
+}
+
+template<typename SampleType>
+void MBCompTutorialAudioProcessor::processBand(size_t band)
+{
+    auto& engine = getEngine<SampleType>();
+    auto& comp = engine.compressors[band];
+    
+    MBCOMP_PROFILE(profiler, Profile_Band_0 + static_cast<int>(band), 1 + static_cast<int>(band));
+    
+    auto& bandBuffer = engine.filterBuffers[band];
+    
+    if ( bandActive[band] && !comp.bypass->get() )
+        comp.process(bandBuffer, numKeyChannels);
+    else
+        comp.skip(bandBuffer, numKeyChannels);
+    
+    // taken every block, so it never holds reduction from before the editor opened
+    auto reduction = comp.takeGainReduction();
+    
+    if ( metering )
+    {
+        auto& meters = meterAccumulator;
+        meters.bands[band].measure(bandBuffer, bandBuffer.getNumChannels() - numKeyChannels, 0, bandBuffer.getNumSamples());
+        meters.gainReduction[band] = juce::jmax(meters.gainReduction[band], reduction);
+    }
+}
+
+template<typename SampleType>
+void MBCompTutorialAudioProcessor::sumBands(juce::AudioBuffer<SampleType>& buffer, int start, int numSamples)
+{
+    auto& engine = getEngine<SampleType>();
+    auto& filterBuffers = engine.filterBuffers;
+    
+    MBCOMP_PROFILE(profiler, Profile_Sum);
+    
+    auto numChannels = juce::jmin(getTotalNumOutputChannels(), filterBuffers[0].getNumChannels() - numKeyChannels);
+    
+    auto ramping = outputGain.isSmoothing()
+                || std::any_of(bandGains.begin(), bandGains.end(), [](const auto& g) { return g.isSmoothing(); });
+    
+    // weighted sum of every band and the output gain in one pass over each channel,
+    // silent bands have weight 0 so the band loop stays a compile time constant
+    if ( ramping )
+    {
+        for ( auto n = 0; n < numSamples; ++n )
+        {
+            auto out = outputGain.getNextValue();
+            
+            for ( size_t b = 0; b < numBands; ++b )
+                engine.bandWeights.setSample(static_cast<int>(b), n, out * bandGains[b].getNextValue());
+        }
+        
+        std::array<const SampleType*, numBands> weights;
+        for ( size_t b = 0; b < numBands; ++b )
+            weights[b] = engine.bandWeights.getReadPointer(static_cast<int>(b));
+        
+        for ( auto ch = 0; ch < numChannels; ++ch )
+        {
+            auto* dest = buffer.getWritePointer(ch, start);
+            
+            std::array<const SampleType*, numBands> src;
+            for ( size_t b = 0; b < numBands; ++b )
+                src[b] = filterBuffers[b].getReadPointer(ch);
+            
+            for ( auto n = 0; n < numSamples; ++n )
+            {
+                SampleType sum = 0;
+                
+                for ( size_t b = 0; b < numBands; ++b )
+                    sum += weights[b][n] * src[b][n];
+                
+                dest[n] = sum;
+            }
+        }
+    }
+    else
+    {
+        std::array<SampleType, numBands> weights;
+        for ( size_t b = 0; b < numBands; ++b )
+            weights[b] = outputGain.getCurrentValue() * bandGains[b].getCurrentValue();
+        
+        for ( auto ch = 0; ch < numChannels; ++ch )
+        {
+            auto* dest = buffer.getWritePointer(ch, start);
+            
+            std::array<const SampleType*, numBands> src;
+            for ( size_t b = 0; b < numBands; ++b )
+                src[b] = filterBuffers[b].getReadPointer(ch);
+            
+            for ( auto n = 0; n < numSamples; ++n )
+            {
+                SampleType sum = 0;
+                
+                for ( size_t b = 0; b < numBands; ++b )
+                    sum += weights[b] * src[b][n];
+                
+                dest[n] = sum;
+            }
+        }
+    }
+    
+    for ( auto ch = numChannels; ch < getTotalNumOutputChannels(); ++ch )
+        buffer.clear(ch, start, numSamples);
+}
+
+template<typename SampleType>
+void MBCompTutorialAudioProcessor::splitBands(const juce::AudioBuffer<SampleType> &inputBuffer, int start, int numSamples, int numChannels)
+{
+    auto& engine = getEngine<SampleType>();
+    auto& filterBuffers = engine.filterBuffers;
+    
+    // match the sub-block length and channel count without reallocating, prepareToPlay
+    // reserved the space. The crossovers split as many channels as the bands have
+    for ( auto& fb : filterBuffers )
+        fb.setSize(numChannels, numSamples, false, false, true);
+    
+    // single pass over the input, each band written straight into its filterBuffer
+    if ( linearPhase )
+        linearPhaseCrossover.process(inputBuffer, filterBuffers, numSamples, start);
+    else
+        engine.crossover.process(inputBuffer, filterBuffers, numSamples, start);
 }
 
 void MBCompTutorialAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    process(buffer);
+}
+
+void MBCompTutorialAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    process(buffer);
+}
+
+template<typename SampleType>
+void MBCompTutorialAudioProcessor::process(juce::AudioBuffer<SampleType>& buffer)
 {
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
@@ -267,60 +764,151 @@ void MBCompTutorialAudioProcessor::processBlock (juce::AudioBuffer<float>& buffe
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
    
-    updateState();
+    updateState<SampleType>();
     
-    applyGain(buffer, inputGain);
-        
-    splitBands(buffer);
-    
-    for ( size_t i = 0; i < filterBuffers.size(); ++i )
-        compressors[i].process(filterBuffers[i]);
+    planBands();
     
-    auto numSamples = buffer.getNumSamples();
-    auto numChannels = buffer.getNumChannels();
+    // keyed bands carry the sidechain's band after the audio, one crossover pass splits both
+    numKeyChannels = externalSidechainParam->get() ? numSidechainChannels : 0;
     
-    buffer.clear();
+    // whatever was measured or left unread from before the editor was closed is stale
+    auto wasMetering = metering;
+    metering = meteringActive.load(std::memory_order_relaxed);
     
-    auto addFilterBand = [nc = numChannels, ns = numSamples](auto& inputBuffer, const auto& source)
+    if ( metering && !wasMetering )
     {
-        for ( auto i = 0; i < nc; ++i )
-            inputBuffer.addFrom(i, 0, source, i, 0, ns);
-    };
+        meterChannel.reclaim();
+        meterAccumulator.reset();
+    }
     
-    auto bandSolod = false;
-    for ( auto& comp : compressors )
+    // the sidechain counts too while it's keying, the envelopes still follow it
+    if ( !isSilent(buffer, getMainBusNumOutputChannels() + numKeyChannels) )
+    {
+        silentSamples = 0;
+        sleeping = false;
+    }
+    else if ( !sleeping && tailSamples >= 0 )
     {
-        if ( comp.solo->get() )
+        // this block counts too, once the tail has run out within it there's nothing left to hear
+        silentSamples += buffer.getNumSamples();
+        
+        if ( silentSamples >= tailSamples )
         {
-            bandSolod = true;
-            break;
+            resetDsp<SampleType>();
+            sleeping = true;
         }
     }
     
-    if ( bandSolod )
+    if ( sleeping )
     {
-        for ( size_t i = 0; i < compressors.size(); ++i )
+        buffer.clear();
+        
+        // the gains carry on towards whatever was set in the meantime, so waking up doesn't
+        // ramp from where they were when the chain fell asleep. The input gain has no skip,
+        // it runs over the cleared buffer while it's moving
+        auto& inputGain = getEngine<SampleType>().inputGain;
+        
+        if ( inputGain.isSmoothing() )
+            applyGain(juce::dsp::AudioBlock<SampleType>(buffer), inputGain);
+        
+        outputGain.skip(buffer.getNumSamples());
+        
+        for ( auto& gain : bandGains )
+            gain.skip(buffer.getNumSamples());
+        
+        // and so do the crossover glides
+        getEngine<SampleType>().crossover.skip(buffer.getNumSamples());
+        
+        // the meters and the analyzer fall back as they would for processed silence
+        if ( metering )
         {
-            auto& comp = compressors[i];
-            if ( comp.solo->get() )
-            {
-                addFilterBand(buffer, filterBuffers[i]);
-            }
+            auto numMainChannels = getMainBusNumOutputChannels();
+            auto& meters = meterAccumulator;
+            
+            meters.input.measure(buffer, numMainChannels, 0, buffer.getNumSamples());
+            meters.output.measure(buffer, numMainChannels, 0, buffer.getNumSamples());
+            inputSpectrum.push(buffer, numMainChannels, 0, buffer.getNumSamples());
+            outputSpectrum.push(buffer, numMainChannels, 0, buffer.getNumSamples());
+            
+            publishMeters();
         }
+        
+        return;
     }
+    
+    // decided once per host block. In parallel the workers get each band's whole host block,
+    // so the pool is woken once per block rather than once per sub-block
+    auto parallel = parallelParam->get() && workerPool.isRunning()
+                 && buffer.getNumSamples() * getMainBusNumOutputChannels() >= minParallelWork;
+    
+    // serially, fixed size pieces keep every band's working set in cache. A host block
+    // bigger than the one prepareToPlay was told about is split up either way
+    auto pieceSize = parallel ? preparedBlockSize : juce::jmin(subBlockSize, preparedBlockSize);
+    
+    for ( auto start = 0; start < buffer.getNumSamples(); start += pieceSize )
+        processSubBlock(buffer, start, juce::jmin(pieceSize, buffer.getNumSamples() - start), parallel);
+    
+    if ( metering )
+        publishMeters();
+}
+
+void MBCompTutorialAudioProcessor::publishMeters()
+{
+    // a frame the editor hasn't picked up yet is taken back and added to, so every block
+    // reaches the editor exactly once however far apart its reads are
+    if ( meterChannel.reclaim() )
+        meterChannel.getWriteSlot().merge(meterAccumulator);
     else
+        meterChannel.getWriteSlot() = meterAccumulator;
+    
+    meterChannel.publish();
+    meterAccumulator.reset();
+}
+
+template<typename SampleType>
+void MBCompTutorialAudioProcessor::processSubBlock(juce::AudioBuffer<SampleType>& buffer, int start, int numSamples, bool parallel)
+{
+    // the sidechain channels follow the main ones in the host buffer, the input gain is for the main signal only
+    auto numMainChannels = getMainBusNumOutputChannels();
+    
+    auto mainChannels = juce::dsp::AudioBlock<SampleType>(buffer).getSubsetChannelBlock(0, static_cast<size_t>(numMainChannels))
+                                                                .getSubBlock(static_cast<size_t>(start), static_cast<size_t>(numSamples));
     {
-        for ( size_t i = 0; i < compressors.size(); ++i )
-        {
-            auto& comp = compressors[i];
-            if ( !comp.mute->get() )
-            {
-                addFilterBand(buffer, filterBuffers[i]);
-            }
-        }
+        MBCOMP_PROFILE(profiler, Profile_Input_Gain);
+        applyGain(mainChannels, getEngine<SampleType>().inputGain);
+    }
+    
+    if ( metering )
+    {
+        meterAccumulator.input.measure(buffer, numMainChannels, start, numSamples);
+        inputSpectrum.push(buffer, numMainChannels, start, numSamples);
+    }
+    
+    // every band still goes through the crossover so the filter state is
+    // continuous when a band is un-muted, only the compression is skipped
+    {
+        MBCOMP_PROFILE(profiler, Profile_Split);
+        splitBands(buffer, start, numSamples, numMainChannels + numKeyChannels);
+    }
+    
+    if ( parallel )
+    {
+        auto bandTask = [this](int band) { processBand<SampleType>(static_cast<size_t>(band)); };
+        workerPool.run(static_cast<int>(numBands), bandTask);
+    }
+    else
+    {
+        for ( size_t i = 0; i < numBands; ++i )
+            processBand<SampleType>(i);
     }
     
-    applyGain(buffer, outputGain);
+    sumBands(buffer, start, numSamples);
+    
+    if ( metering )
+    {
+        meterAccumulator.output.measure(buffer, numMainChannels, start, numSamples);
+        outputSpectrum.push(buffer, numMainChannels, start, numSamples);
+    }
 }
 
 //==============================================================================
@@ -371,55 +959,81 @@ juce::AudioProcessorValueTreeState::ParameterLayout MBCompTutorialAudioProcessor
     addFloatParam(layout, params.at(Params::Names::Gain_In), gainRange, 0.f);
     addFloatParam(layout, params.at(Params::Names::Gain_Out), gainRange, 0.f);
     
+    // per band params are grouped by type (all thresholds, then all attacks...)
+    // to keep the host parameter order of the original 3 band layout
+    auto bandName = [](Params::BandNames param, size_t band) { return Params::getBandParamName(param, band); };
+    
     // Threshold
     auto thresholdRange = juce::NormalisableRange<float>(-60.f, 12.f, 1.f, 1.f);
-    addFloatParam(layout, params.at(Params::Names::Threshold_Low_Band), thresholdRange, 0.f);
-    addFloatParam(layout, params.at(Params::Names::Threshold_Mid_Band), thresholdRange, 0.f);
-    addFloatParam(layout, params.at(Params::Names::Threshold_High_Band), thresholdRange, 0.f);
+    for ( size_t i = 0; i < numBands; ++i )
+        addFloatParam(layout, bandName(Params::Threshold, i), thresholdRange, 0.f);
     
     // Attack/Release
     auto attackReleaseRange = juce::NormalisableRange<float>(5.f, 500.f, 1.f, 1.f);
-    addFloatParam(layout, params.at(Params::Names::Attack_Low_Band), attackReleaseRange, 50.f);
-    addFloatParam(layout, params.at(Params::Names::Attack_Mid_Band), attackReleaseRange, 50.f);
-    addFloatParam(layout, params.at(Params::Names::Attack_High_Band), attackReleaseRange, 50.f);
-    
-    addFloatParam(layout, params.at(Params::Names::Release_Low_Band), attackReleaseRange, 250.f);
-    addFloatParam(layout, params.at(Params::Names::Release_Mid_Band), attackReleaseRange, 250.f);
-    addFloatParam(layout, params.at(Params::Names::Release_High_Band), attackReleaseRange, 250.f);
+    for ( size_t i = 0; i < numBands; ++i )
+        addFloatParam(layout, bandName(Params::Attack, i), attackReleaseRange, 50.f);
     
-    //       Ratio
-    //   1:1 = no compression
-    // 100:1 = brick wall compression
+    for ( size_t i = 0; i < numBands; ++i )
+        addFloatParam(layout, bandName(Params::Release, i), attackReleaseRange, 250.f);
     
-    auto choices = std::vector<double>{ 1, 1.5, 2, 3, 4, 5, 6, 7, 8, 10, 15, 20, 50, 100 };
+    // Ratio
     juce::StringArray ratioChoices;
-    for ( auto choice : choices )
+    for ( auto choice : Params::ratioChoices )
     {
         ratioChoices.add( juce::String(choice, 1) );
     }
     
-    layout.add(std::make_unique<juce::AudioParameterChoice>(params.at(Params::Names::Ratio_Low_Band), params.at(Params::Names::Ratio_Low_Band), ratioChoices, 3));
-    layout.add(std::make_unique<juce::AudioParameterChoice>(params.at(Params::Names::Ratio_Mid_Band), params.at(Params::Names::Ratio_Mid_Band), ratioChoices, 3));
-    layout.add(std::make_unique<juce::AudioParameterChoice>(params.at(Params::Names::Ratio_High_Band), params.at(Params::Names::Ratio_High_Band), ratioChoices, 3));
+    for ( size_t i = 0; i < numBands; ++i )
+        layout.add(std::make_unique<juce::AudioParameterChoice>(bandName(Params::Ratio, i), bandName(Params::Ratio, i), ratioChoices, 3));
     
     // Bypass
-    addBoolParam(layout, params.at(Params::Names::Bypass_Low_Band), false);
-    addBoolParam(layout, params.at(Params::Names::Bypass_Mid_Band), false);
-    addBoolParam(layout, params.at(Params::Names::Bypass_High_Band), false);
+    for ( size_t i = 0; i < numBands; ++i )
+        addBoolParam(layout, bandName(Params::Bypass, i), false);
 
     // Mute
-    addBoolParam(layout, params.at(Params::Names::Mute_Low_Band), false);
-    addBoolParam(layout, params.at(Params::Names::Mute_Mid_Band), false);
-    addBoolParam(layout, params.at(Params::Names::Mute_High_Band), false);
+    for ( size_t i = 0; i < numBands; ++i )
+        addBoolParam(layout, bandName(Params::Mute, i), false);
 
     // Solo
-    addBoolParam(layout, params.at(Params::Names::Solo_Low_Band), false);
-    addBoolParam(layout, params.at(Params::Names::Solo_Mid_Band), false);
-    addBoolParam(layout, params.at(Params::Names::Solo_High_Band), false);
+    for ( size_t i = 0; i < numBands; ++i )
+        addBoolParam(layout, bandName(Params::Solo, i), false);
 
     // Crossover
-    addFloatParam(layout, params.at(Params::Names::Low_Mid_Crossover_Freq), juce::NormalisableRange<float>(20.f, 999.f, 1.f, 1.f), 400.f);
-    addFloatParam(layout, params.at(Params::Names::Mid_High_Crossover_Freq), juce::NormalisableRange<float>(1000.f, 20000.f, 1.f, 1.f), 2000.f);
+    for ( size_t i = 0; i < Params::numCrossovers; ++i )
+        addFloatParam(layout, Params::getCrossoverParamName(i), Params::getCrossoverRange(i), Params::getCrossoverDefault(i));
+    
+    // added after the original layout so existing host parameter indices don't move
+    
+    // Knee - 0 dB is the hard knee the original compressor had
+    for ( size_t i = 0; i < numBands; ++i )
+        addFloatParam(layout, bandName(Params::Knee, i), juce::NormalisableRange<float>(0.f, 24.f, 0.5f, 1.f), 0.f);
+    
+    // Detector
+    for ( size_t i = 0; i < numBands; ++i )
+        layout.add(std::make_unique<juce::AudioParameterChoice>(bandName(Params::Detector, i), bandName(Params::Detector, i), Params::getDetectorChoices(), 0));
+    
+    // Crossover mode
+    layout.add(std::make_unique<juce::AudioParameterChoice>(params.at(Params::Names::Crossover_Mode), params.at(Params::Names::Crossover_Mode), Params::getCrossoverModeChoices(), 0));
+    
+    // Parallel processing - bands on worker threads
+    addBoolParam(layout, params.at(Params::Names::Parallel_Processing), false);
+    
+    // Lookahead - ms, the plugin latency follows the longest band
+    for ( size_t i = 0; i < numBands; ++i )
+        addFloatParam(layout, bandName(Params::Lookahead, i), juce::NormalisableRange<float>(0.f, CompressorBase::maxLookaheadMs, 0.1f, 1.f), 0.f);
+    
+    // Oversampling - for the compressor's gain changes, the band filters stay at the base rate
+    for ( size_t i = 0; i < numBands; ++i )
+        layout.add(std::make_unique<juce::AudioParameterChoice>(bandName(Params::Oversampling, i), bandName(Params::Oversampling, i), Params::getOversamplingChoices(), 0));
+    
+    // Channel link - Off keeps every channel independent like the original stereo version
+    layout.add(std::make_unique<juce::AudioParameterChoice>(params.at(Params::Names::Channel_Link), params.at(Params::Names::Channel_Link), Params::getChannelLinkChoices(), Params::Link_Off));
+    
+    // Link mode - how linked channels are combined into their shared sidechain
+    layout.add(std::make_unique<juce::AudioParameterChoice>(params.at(Params::Names::Link_Mode), params.at(Params::Names::Link_Mode), Params::getLinkModeChoices(), 0));
+    
+    // External sidechain - each band detects from the same band of the sidechain bus, when the host connects one
+    addBoolParam(layout, params.at(Params::Names::External_Sidechain), false);
     
     return layout;
 }
@@ -9,83 +9,198 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "Crossover.h"
+#include "LinearPhaseCrossover.h"
+#include "WorkerPool.h"
+#include "Compressor.h"
+#include "Profiler.h"
+#include "Metering.h"
+
+// band count is fixed per build, set MBCOMP_NUM_BANDS in the exporter's
+// preprocessor definitions for 2 to 8 band variants
+#ifndef MBCOMP_NUM_BANDS
+ #define MBCOMP_NUM_BANDS 3
+#endif
+
+// host blocks are split, compressed and summed this many samples at a time, so the
+// band buffers stay in cache whatever block size the host sends. Parallel processing
+// hands the workers whole host blocks instead
+#ifndef MBCOMP_SUB_BLOCK_SIZE
+ #define MBCOMP_SUB_BLOCK_SIZE 128
+#endif
 
 namespace Params
 {
 
+static constexpr size_t numBands = MBCOMP_NUM_BANDS;
+static constexpr size_t numCrossovers = numBands - 1;
+
+static_assert(numBands >= 2 && numBands <= 8, "MBCOMP_NUM_BANDS must be between 2 and 8");
+
 enum Names
 {
-    Low_Mid_Crossover_Freq,
-    Mid_High_Crossover_Freq,
+    Gain_In,
+    Gain_Out,
+    Crossover_Mode,
+    Parallel_Processing,
+    Channel_Link,
+    Link_Mode,
+    External_Sidechain
+};
+
+// per band parameters, one of each for every band
+enum BandNames
+{
+    Threshold,
+    Attack,
+    Release,
+    Ratio,
+    Bypass,
+    Mute,
+    Solo,
+    Knee,
+    Detector,
+    Lookahead,
+    Oversampling
+};
+
+inline const std::map<Names, juce::String>& getParams()
+{
+    static std::map<Names, juce::String> params =
+    {
+        { Gain_In,                 "Gain In" },
+        { Gain_Out,                "Gain Out" },
+        { Crossover_Mode,          "Crossover Mode" },
+        { Parallel_Processing,     "Parallel Processing" },
+        { Channel_Link,            "Channel Link" },
+        { Link_Mode,               "Link Mode" },
+        { External_Sidechain,      "External Sidechain" }
+    };
     
-    Threshold_Low_Band,
-    Threshold_Mid_Band,
-    Threshold_High_Band,
+    return params;
+}
+
+//       Ratio
+//   1:1 = no compression
+// 100:1 = brick wall compression
+// the choice index maps straight into this table, no string parsing on the audio thread
+static constexpr std::array<float, 14> ratioChoices { 1.f, 1.5f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f, 8.f, 10.f, 15.f, 20.f, 50.f, 100.f };
+
+// choice index order matches CompressorBase::Detector
+inline juce::StringArray getDetectorChoices()
+{
+    return { "Peak", "RMS" };
+}
+
+// choice index is the log2 of the factor
+inline juce::StringArray getOversamplingChoices()
+{
+    return { "1x", "2x", "4x", "8x" };
+}
+
+// choice index 1 switches splitBands() over to the LinearPhaseCrossover
+inline juce::StringArray getCrossoverModeChoices()
+{
+    return { "IIR", "Linear Phase" };
+}
+
+// which channels share a detector, see MBCompTutorialAudioProcessor::buildChannelGroups()
+enum ChannelLink
+{
+    Link_Off,
+    Link_Pairs,
+    Link_Surround,
+    Link_All,
+    Num_Channel_Links
+};
 
-    Attack_Low_Band,
-    Attack_Mid_Band,
-    Attack_High_Band,
+inline juce::StringArray getChannelLinkChoices()
+{
+    return { "Off", "Pairs", "Surround", "All" };
+}
 
-    Release_Low_Band,
-    Release_Mid_Band,
-    Release_High_Band,
+// choice index order matches CompressorBase::Link
+inline juce::StringArray getLinkModeChoices()
+{
+    return { "Max", "Sum" };
+}
 
-    Ratio_Low_Band,
-    Ratio_Mid_Band,
-    Ratio_High_Band,
+// Low, Mid, High for 3 bands - Low, Mid 1, Mid 2, ..., High otherwise
+inline juce::String getBandName(size_t band)
+{
+    jassert(band < numBands);
     
-    Bypass_Low_Band,
-    Bypass_Mid_Band,
-    Bypass_High_Band,
+    if ( band == 0 )
+        return "Low";
     
-    Mute_Low_Band,
-    Mute_Mid_Band,
-    Mute_High_Band,
+    if ( band == numBands - 1 )
+        return "High";
     
-    Solo_Low_Band,
-    Solo_Mid_Band,
-    Solo_High_Band,
+    if ( numBands == 3 )
+        return "Mid";
     
-    Gain_In,
-    Gain_Out
-};
+    return "Mid " + juce::String(band);
+}
 
-inline const std::map<Names, juce::String>& getParams()
+inline juce::String getBandParamName(BandNames param, size_t band)
 {
-    static std::map<Names, juce::String> params =
+    static const std::map<BandNames, juce::String> prefixes =
     {
-        { Low_Mid_Crossover_Freq,  "Low-Mid Crossover Frequency" },
-        { Mid_High_Crossover_Freq, "Mid-High Crossover Frequency" },
-        { Threshold_Low_Band,      "Threshold Low Band" },
-        { Threshold_Mid_Band,      "Threshold Mid Band" },
-        { Threshold_High_Band,     "Threshold High Band" },
-        { Attack_Low_Band,         "Attack Low Band" },
-        { Attack_Mid_Band,         "Attack Mid Band" },
-        { Attack_High_Band,        "Attack High Band" },
-        { Release_Low_Band,        "Release Low Band" },
-        { Release_Mid_Band,        "Release Mid Band" },
-        { Release_High_Band,       "Release High Band" },
-        { Ratio_Low_Band,          "Ratio Low Band" },
-        { Ratio_Mid_Band,          "Ratio Mid Band" },
-        { Ratio_High_Band,         "Ratio High Band" },
-        { Bypass_Low_Band,         "Bypass Low Band" },
-        { Bypass_Mid_Band,         "Bypass Mid Band" },
-        { Bypass_High_Band,        "Bypass High Band" },
-        { Mute_Low_Band,           "Mute Low Band" },
-        { Mute_Mid_Band,           "Mute Mid Band" },
-        { Mute_High_Band,          "Mute High Band" },
-        { Solo_Low_Band,           "Solo Low Band" },
-        { Solo_Mid_Band,           "Solo Mid Band" },
-        { Solo_High_Band,          "Solo High Band" },
-        { Gain_In,                 "Gain In" },
-        { Gain_Out,                "Gain Out" }
+        { Threshold, "Threshold" },
+        { Attack,    "Attack" },
+        { Release,   "Release" },
+        { Ratio,     "Ratio" },
+        { Bypass,    "Bypass" },
+        { Mute,      "Mute" },
+        { Solo,      "Solo" },
+        { Knee,      "Knee" },
+        { Detector,  "Detector" },
+        { Lookahead, "Lookahead" },
+        { Oversampling, "Oversampling" }
     };
     
-    return params;
+    return prefixes.at(param) + " " + getBandName(band) + " Band";
+}
+
+// crossover i sits between band i and band i + 1, eg. "Low-Mid Crossover Frequency"
+inline juce::String getCrossoverParamName(size_t crossover)
+{
+    jassert(crossover < numCrossovers);
+    return getBandName(crossover) + "-" + getBandName(crossover + 1) + " Crossover Frequency";
+}
+
+// non-overlapping ranges keep the crossovers in ascending order
+inline juce::NormalisableRange<float> getCrossoverRange(size_t crossover)
+{
+    // 3 bands keep the original ranges so existing sessions recall the same values
+    if ( numBands == 3 )
+    {
+        return crossover == 0 ? juce::NormalisableRange<float>(20.f, 999.f, 1.f, 1.f)
+                              : juce::NormalisableRange<float>(1000.f, 20000.f, 1.f, 1.f);
+    }
+    
+    // otherwise split 20Hz - 20kHz into equal log spaced regions
+    auto edge = [](size_t i)
+    {
+        return std::round(20.f * std::pow(1000.f, static_cast<float>(i) / static_cast<float>(numCrossovers)));
+    };
+    
+    auto end = crossover == numCrossovers - 1 ? edge(crossover + 1) : edge(crossover + 1) - 1.f;
+    return juce::NormalisableRange<float>(edge(crossover), end, 1.f, 1.f);
 }
 
+inline float getCrossoverDefault(size_t crossover)
+{
+    if ( numBands == 3 )
+        return crossover == 0 ? 400.f : 2000.f;
+    
+    auto range = getCrossoverRange(crossover);
+    return std::round(std::sqrt(range.start * range.end));
 }
 
+}
+
+template<typename SampleType>
 struct CompressorBand
 {
     // cached ptrs for params
@@ -93,41 +208,189 @@ struct CompressorBand
     juce::AudioParameterFloat* attack { nullptr };
     juce::AudioParameterFloat* release { nullptr };
     juce::AudioParameterChoice* ratio { nullptr };
+    juce::AudioParameterFloat* knee { nullptr };
+    juce::AudioParameterChoice* detector { nullptr };
+    juce::AudioParameterFloat* lookahead { nullptr };
+    juce::AudioParameterChoice* oversampling { nullptr };
     juce::AudioParameterBool* bypass { nullptr };
     juce::AudioParameterBool* mute { nullptr };
     juce::AudioParameterBool* solo { nullptr };
     
-    void prepare(const juce::dsp::ProcessSpec& spec)
+    // spec.numChannels is the compressed channels, numKeyChannels the sidechain bands that
+    // may follow them in the band buffer. Both go through the same oversampler
+    void prepare(const juce::dsp::ProcessSpec& spec, int numKeyChannels)
     {
-        compressor.prepare(spec);
+        baseSampleRate = spec.sampleRate;
+        
+        // one oversampler per factor, built up front so switching never allocates.
+        // FIR half band stages are linear phase with a whole sample latency,
+        // which a plain delay can line up with the other bands
+        for ( size_t i = 0; i < oversamplers.size(); ++i )
+        {
+            oversamplers[i] = std::make_unique<juce::dsp::Oversampling<SampleType>>(spec.numChannels + static_cast<size_t>(numKeyChannels), i + 1,
+                                                                                juce::dsp::Oversampling<SampleType>::filterHalfBandFIREquiripple,
+                                                                                true, true);
+            oversamplers[i]->initProcessing(spec.maximumBlockSize);
+        }
+        
+        auto maxFactor = 1u << oversamplers.size();
+        compressor.prepare({ spec.sampleRate * maxFactor, spec.maximumBlockSize * maxFactor, spec.numChannels });
+        
+        channelPointers.resize(spec.numChannels + static_cast<size_t>(numKeyChannels));
+        keyPointers.resize(spec.numChannels);
+        
+        // picked up again by the next updateCompressorSettings()
+        factorIndex = -1;
     }
     
     void updateCompressorSettings()
     {
+        auto newFactorIndex = oversampling->getIndex();
+        if ( newFactorIndex != factorIndex )
+        {
+            factorIndex = newFactorIndex;
+            compressor.setSampleRate(baseSampleRate * getFactor());
+            
+            if ( auto* os = getOversampler() )
+                os->reset();
+        }
+        
         compressor.setThreshold(threshold->get());
         compressor.setAttack(attack->get());
         compressor.setRelease(release->get());
-        compressor.setRatio(ratio->getCurrentChoiceName().getFloatValue());
+        compressor.setRatio(Params::ratioChoices[static_cast<size_t>(ratio->getIndex())]);
+        compressor.setKnee(knee->get());
+        compressor.setDetector(static_cast<CompressorBase::Detector>(detector->getIndex()));
+        compressor.setLookahead(lookahead->get());
     }
     
-    void process(juce::AudioBuffer<float>& buffer)
+    // linked channels run one envelope and one gain curve between them
+    void setChannelLink(const std::vector<int>& groups, CompressorBase::Link link)
     {
-        auto block = juce::dsp::AudioBlock<float>(buffer);
-        auto context = juce::dsp::ProcessContextReplacing<float>(block);
-        
-        // toggle bypass (bool) on the processing context
-        context.isBypassed = bypass->get();
+        compressor.setChannelGroups(groups);
+        compressor.setLink(link);
+    }
+    
+    // deepest reduction since the last call in dB, for the meters
+    float takeGainReduction() { return compressor.takeGainReduction(); }
+    
+    // back to silence, as if nothing had been played since prepare()
+    void reset()
+    {
+        compressor.reset();
         
-        compressor.process(context);
+        for ( auto& os : oversamplers )
+            if ( os != nullptr )
+                os->reset();
+    }
+    
+    // how long the gain takes to recover after the input stops
+    double getTailSeconds() const { return compressor.getReleaseSeconds(); }
+    
+    // the least latency this band can run at, in base rate samples:
+    // oversampling filters plus the lookahead rounded up to whole base samples
+    int getLatencySamples() const
+    {
+        auto factor = getFactor();
+        return getOversamplingLatency() + (compressor.getLookaheadSamples() + factor - 1) / factor;
+    }
+    
+    // every band's audio is delayed to the same total so they still line up when summed,
+    // whatever the oversampling doesn't use up is made up in the compressor's delay line
+    void setLatency(int samples)
+    {
+        jassert(samples >= getLatencySamples());
+        compressor.setLatency((samples - getOversamplingLatency()) * getFactor());
+    }
+    
+    // the last numKeyChannels channels of buffer are the sidechain's band, the detector
+    // listens to them instead of the audio. Mono keys every channel, otherwise channel by channel
+    void process(juce::AudioBuffer<SampleType>& buffer, int numKeyChannels)
+    {
+        run(buffer, numKeyChannels, [this](SampleType* const* channels, const SampleType* const* keys, int numChannels, int numSamples)
+        {
+            compressor.process(channels, keys, numChannels, numSamples);
+        });
+    }
+    
+    // called instead of process() for blocks where the band isn't compressed,
+    // only the envelope and the delays run so the band comes back with the right
+    // gain reduction, and a bypassed band stays aligned with the others
+    void skip(juce::AudioBuffer<SampleType>& buffer, int numKeyChannels)
+    {
+        run(buffer, numKeyChannels, [this](SampleType* const* channels, const SampleType* const* keys, int numChannels, int numSamples)
+        {
+            compressor.track(channels, keys, numChannels, numSamples);
+        });
     }
 private:
-    juce::dsp::Compressor<float> compressor;
+    Compressor<SampleType> compressor;
+    
+    // 2x, 4x, 8x - 1x runs the compressor straight on the band
+    std::array<std::unique_ptr<juce::dsp::Oversampling<SampleType>>, 3> oversamplers;
+    int factorIndex { 0 };
+    double baseSampleRate { 44100.0 };
+    
+    std::vector<SampleType*> channelPointers;
+    std::vector<const SampleType*> keyPointers;
+    
+    int getFactor() const { return 1 << juce::jmax(0, factorIndex); }
+    
+    juce::dsp::Oversampling<SampleType>* getOversampler() const
+    {
+        return factorIndex > 0 ? oversamplers[static_cast<size_t>(factorIndex - 1)].get() : nullptr;
+    }
+    
+    int getOversamplingLatency() const
+    {
+        auto* os = getOversampler();
+        return os != nullptr ? static_cast<int>(os->getLatencyInSamples()) : 0;
+    }
+    
+    template<typename Fn>
+    void run(juce::AudioBuffer<SampleType>& buffer, int numKeyChannels, Fn&& compressorPass)
+    {
+        auto* os = getOversampler();
+        
+        auto numChannels = juce::jmin(buffer.getNumChannels(), static_cast<int>(channelPointers.size()));
+        auto numSamples = buffer.getNumSamples();
+        auto block = juce::dsp::AudioBlock<SampleType>(buffer);
+        
+        if ( os != nullptr )
+        {
+            auto upsampled = os->processSamplesUp(block);
+            numSamples = static_cast<int>(upsampled.getNumSamples());
+            
+            for ( auto ch = 0; ch < numChannels; ++ch )
+                channelPointers[static_cast<size_t>(ch)] = upsampled.getChannelPointer(static_cast<size_t>(ch));
+        }
+        else
+        {
+            for ( auto ch = 0; ch < numChannels; ++ch )
+                channelPointers[static_cast<size_t>(ch)] = buffer.getWritePointer(ch);
+        }
+        
+        auto numCompressed = juce::jmin(numChannels - numKeyChannels, static_cast<int>(keyPointers.size()));
+        
+        if ( numKeyChannels > 0 )
+        {
+            for ( auto ch = 0; ch < numCompressed; ++ch )
+                keyPointers[static_cast<size_t>(ch)] = channelPointers[static_cast<size_t>(numCompressed + ch % numKeyChannels)];
+        }
+        
+        compressorPass(channelPointers.data(), numKeyChannels > 0 ? keyPointers.data() : nullptr, numCompressed, numSamples);
+        
+        if ( os != nullptr )
+            os->processSamplesDown(block);
+    }
 };
 
 //==============================================================================
 /**
 */
-class MBCompTutorialAudioProcessor  : public juce::AudioProcessor
+class MBCompTutorialAudioProcessor  : public juce::AudioProcessor,
+                                      private juce::AudioProcessorParameter::Listener,
+                                      private juce::Timer
 {
 public:
     //==============================================================================
@@ -143,6 +406,10 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    
+    // both precisions run natively, from the same templated dsp
+    bool supportsDoublePrecisionProcessing() const override { return true; }
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -171,38 +438,234 @@ public:
     static APVTS::ParameterLayout createParameterLayout();
     
     APVTS apvts { *this, nullptr, "Parameters", createParameterLayout() };
+    
+    static constexpr size_t numBands = Params::numBands;
+    
+    // any discrete, surround or ambisonic layout up to this many channels
+    static constexpr int maxChannels = 16;
+    
+    // host blocks are processed serially in pieces of this many samples
+    static constexpr int subBlockSize = MBCOMP_SUB_BLOCK_SIZE;
+    static_assert(subBlockSize >= 16 && subBlockSize <= 4096, "MBCOMP_SUB_BLOCK_SIZE must be between 16 and 4096");
+    
+    using Meters = MeterFrame<numBands>;
+    
+    // the editor turns metering on while it's open, nothing is measured otherwise
+    void setMeteringActive(bool shouldMeter) { meteringActive.store(shouldMeter, std::memory_order_relaxed); }
+    
+    // message thread, false if no block finished since the last call
+    bool readMeters(Meters& dest) { return meterChannel.read(dest); }
+    
+    // mono feeds for the editor's spectrum analyzer, after the input gain and at the
+    // output - filled alongside the meters, so only while the editor is open
+    AnalyzerFifo inputSpectrum, outputSpectrum;
 private:
-    std::array<CompressorBand, 3> compressors;
-    CompressorBand& lowBandComp = compressors[0];
-    CompressorBand& midBandComp = compressors[1];
-    CompressorBand& highBandComp = compressors[2];
+    // what prepareToPlay sized the buffers for, the host's maximum block size. Longer
+    // host blocks are split into pieces of this
+    int preparedBlockSize { subBlockSize };
+    
+    // the rate prepareToPlay was given
+    double preparedSampleRate { 0.0 };
+    
+    // everything that runs at the host's sample precision. Only the engine matching
+    // isUsingDoublePrecision() is prepared, the other one stays empty
+    template<typename SampleType>
+    struct Engine
+    {
+        // both engines' bands point at the same params
+        std::array<CompressorBand<SampleType>, numBands> compressors;
+        
+        // fused LR4 tree, replaces the separate LP1/AP2/HP1/LP2/HP2 filters
+        Crossover<numBands, SampleType> crossover;
+        
+        std::array<juce::AudioBuffer<SampleType>, numBands> filterBuffers;
+        
+        // per sample band * output gain, only filled while something is ramping
+        juce::AudioBuffer<SampleType> bandWeights;
+        
+        juce::dsp::Gain<SampleType> inputGain;
+    };
+    
+    Engine<float> floatEngine;
+    Engine<double> doubleEngine;
+    
+    template<typename SampleType>
+    Engine<SampleType>& getEngine()
+    {
+        if constexpr ( std::is_same<SampleType, double>::value )
+            return doubleEngine;
+        else
+            return floatEngine;
+    }
+    
+    template<typename SampleType>
+    void prepareEngine(const juce::dsp::ProcessSpec& spec);
+    
+    template<typename SampleType>
+    void process(juce::AudioBuffer<SampleType>& buffer);
+    
+    // the whole split, compress and sum chain for samples [start, start + numSamples) of buffer,
+    // with the bands spread over workerPool when parallel
+    template<typename SampleType>
+    void processSubBlock(juce::AudioBuffer<SampleType>& buffer, int start, int numSamples, bool parallel);
+    
+    // FIR alternative, same magnitudes without the phase shift, adds latency.
+    // Shared by both engines, it converts double buffers to float and back.
+    // timerCallback() runs its kernel builder only while linear phase is selected
+    LinearPhaseCrossover<numBands> linearPhaseCrossover;
+    juce::AudioParameterChoice* crossoverModeParam { nullptr };
+    bool linearPhase { false };
+    
+    // lowest crossover first
+    std::array<juce::AudioParameterFloat*, Params::numCrossovers> crossoverFreqs {};
+    
+    // which bands reach the output this block, after solo/mute - a band that is
+    // still fading out counts as active until its gain reaches 0
+    std::array<bool, numBands> bandActive {};
+    
+    // 0/1 per band from solo/mute, ramped so toggles don't click
+    std::array<juce::LinearSmoothedValue<float>, numBands> bandGains;
+    
+    void planBands();
     
-    using Filter = juce::dsp::LinkwitzRileyFilter<float>;
-    //     fc0, fc1
-    Filter LP1, AP2,
-           HP1, LP2,
-                HP2;
+    // sidechain bus channels, 0 when the host left it disabled. While keyed they're split
+    // along with the main channels and sit after them in every band's filterBuffer
+    int numSidechainChannels { 0 };
+    int numKeyChannels { 0 };
+    juce::AudioParameterBool* externalSidechainParam { nullptr };
     
-    juce::AudioParameterFloat* lowMidCrossover { nullptr };
-    juce::AudioParameterFloat* midHighCrossover { nullptr };
+    // compresses (or skips) band i, bands don't share any state so they can run concurrently
+    template<typename SampleType>
+    void processBand(size_t band);
+    
+    // opt-in, spreads the bands over workerPool when the block is big enough to pay for the handoff
+    WorkerPool workerPool;
+    juce::AudioParameterBool* parallelParam { nullptr };
+    
+    // message thread, the workers only exist between prepareToPlay and releaseResources
+    // while parallel processing is switched on. The timer follows the param
+    bool prepared { false };
+    void updateWorkerPool();
+    
+    // samples * channels per band and dispatch below which waking the workers costs more
+    // than it saves, see the band dispatch benchmark in Benchmarks/. A dispatch is a whole
+    // host block, so this compares against the host block size
+    static constexpr int minParallelWork = 512;
+    
+    // group index per channel for every Params::ChannelLink choice, built for the
+    // bus layout in prepareToPlay so switching on the audio thread is just a pick
+    std::array<std::vector<int>, Params::Num_Channel_Links> channelGroups;
+    juce::AudioParameterChoice* channelLinkParam { nullptr };
+    juce::AudioParameterChoice* linkModeParam { nullptr };
+    
+    void buildChannelGroups(const juce::AudioChannelSet& layout);
+    
+    template<typename SampleType>
+    void sumBands(juce::AudioBuffer<SampleType>& buffer, int start, int numSamples);
+    
+    // applied in sumBands() together with the band summation
+    juce::LinearSmoothedValue<float> outputGain;
+    
+   #if MBCOMP_ENABLE_PROFILING
+    // stage ids for MBCOMP_PROFILE, each band gets its own stage and its own trace row
+    // since bands can run on the workers at the same time
+    enum ProfileStage
+    {
+        Profile_Input_Gain,
+        Profile_Split,
+        Profile_Sum,        // includes the output gain, sumBands() applies both in one pass
+        Profile_Band_0      // + band index
+    };
     
-    std::array<juce::AudioBuffer<float>, 3> filterBuffers;
+    Profiler profiler;
     
-    juce::dsp::Gain<float> inputGain, outputGain;
+    // picked on the first prepareToPlay, so instances and sessions don't write over each
+    // other's traces. Later prepares of the same instance start it over
+    juce::File traceFile;
+   #endif
     juce::AudioParameterFloat* inputGainParam { nullptr };
     juce::AudioParameterFloat* outputGainParam { nullptr };
     
-    template<typename T, typename U>
-    void applyGain(T& buffer, U& gain)
+    // one bit per group of params that needs recomputing when any of them moves,
+    // set from parameterValueChanged and consumed once per block in updateState()
+    enum DirtyBits : uint32_t
+    {
+        Dirty_Band_0      = 1u << 0,  // + band index, up to 8 bands
+        Dirty_Crossover_0 = 1u << 8,  // + crossover index
+        Dirty_Gain_In     = 1u << 16,
+        Dirty_Gain_Out    = 1u << 17,
+        Dirty_Crossover_Mode = 1u << 18,
+        Dirty_Channel_Link = 1u << 19,
+        Dirty_All         = ~0u
+    };
+    
+    std::atomic<uint32_t> dirtyParams { Dirty_All };
+    
+    // indexed by AudioProcessorParameter::getParameterIndex(), filled in once by the constructor
+    std::vector<uint32_t> dirtyBitForParam;
+    
+    void watchParam(juce::AudioProcessorParameter* param, uint32_t dirtyBit);
+    
+    void parameterValueChanged(int parameterIndex, float newValue) override;
+    void parameterGestureChanged(int parameterIndex, bool gestureIsStarting) override;
+    
+    template<typename SampleType, typename U>
+    void applyGain(juce::dsp::AudioBlock<SampleType> block, U& gain)
     {
-        auto block = juce::dsp::AudioBlock<float>(buffer);
-        auto ctx = juce::dsp::ProcessContextReplacing<float>(block);
+        auto ctx = juce::dsp::ProcessContextReplacing<SampleType>(block);
         gain.process(ctx);
     }
     
+    template<typename SampleType>
     void updateState();
     
-    void splitBands(const juce::AudioBuffer<float>& inputBuffer);
+    // host latency is the slowest band (lookahead + oversampling), plus the linear phase crossover's
+    template<typename SampleType>
+    void updateLatency();
+    
+    // setLatencySamples() notifies the host under a lock, so from the audio thread the new
+    // latency is only published here and timerCallback() reports it on the message thread
+    std::atomic<int> pendingLatency { 0 };
+    
+    void timerCallback() override;
+    
+    // levels are added into meterAccumulator during the block and published at the end
+    // of it, each band only touches its own entry
+    SnapshotChannel<Meters> meterChannel;
+    Meters meterAccumulator;
+    std::atomic<bool> meteringActive { false };
+    bool metering { false };
+    
+    void publishMeters();
+    
+    // silence in is silence out once the filters and envelopes have rung out, so after
+    // tailSamples of silent input the chain sleeps: sleeping blocks are just cleared,
+    // and the first block with anything in it wakes the chain again. tailSamples is -1
+    // until updateTail() has had a sample rate to work it out with, and until then the
+    // chain never sleeps
+    static constexpr double silenceDb = 120.0;
+    static constexpr float silenceThreshold = 1.0e-6f;    // -silenceDb
+    
+    int silentSamples { 0 };
+    int tailSamples { -1 };
+    bool sleeping { false };
+    
+    // the host's getTailLengthSeconds(), published from the audio thread
+    std::atomic<double> tailSeconds { 0.0 };
+    
+    template<typename SampleType>
+    bool isSilent(const juce::AudioBuffer<SampleType>& buffer, int numChannels) const;
+    
+    // release of the slowest band, the crossover's ringing and the latency
+    template<typename SampleType>
+    void updateTail();
+    
+    // everything back to exact zeros when the chain goes to sleep, so it wakes up clean
+    template<typename SampleType>
+    void resetDsp();
+    
+    template<typename SampleType>
+    void splitBands(const juce::AudioBuffer<SampleType>& inputBuffer, int start, int numSamples, int numChannels);
     
     static void addFloatParam(APVTS::ParameterLayout& layout, const juce::String& name, const juce::NormalisableRange<float>& range, const float defaultVal);
     static void addBoolParam(APVTS::ParameterLayout& layout, const juce::String& name, const bool defaultVal);
@@ -0,0 +1,304 @@
+/*
+  ==============================================================================
+
+    Profiler.h
+    Created: 16 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// off unless the exporter's preprocessor definitions turn it on, MBCOMP_PROFILE()
+// expands to nothing and none of this is compiled
+#ifndef MBCOMP_ENABLE_PROFILING
+ #define MBCOMP_ENABLE_PROFILING 0
+#endif
+
+#if MBCOMP_ENABLE_PROFILING
+
+/*
+    Per stage timing of the audio thread.
+
+    A Scope reads the steady clock when it's created and when it goes out of scope
+    and pushes one event into a bounded lock-free queue. Producers (the audio thread
+    and the band workers) never wait: a full queue drops the event and counts it.
+
+    A background thread drains the queue every few ms into a Chrome trace file
+    (open in chrome://tracing or ui.perfetto.dev). It also keeps the last
+    statsHistory durations of every stage and once a second adds their min/mean/p99
+    to the trace as counter tracks, available from getStats() too.
+*/
+struct Profiler
+{
+    struct Stats
+    {
+        double minUs { 0.0 }, meanUs { 0.0 }, p99Us { 0.0 };
+        int count { 0 };
+    };
+
+    Profiler() : writer(*this) {}
+
+    ~Profiler()
+    {
+        stop();
+    }
+
+    // stageNames are indexed by the stage passed to record(), trackNames by its track -
+    // each track is a row in the trace, stages on one track must not overlap.
+    // Not the audio thread, this opens the file and starts the writer
+    void start(const juce::File& traceFile, const juce::StringArray& stageNames, const juce::StringArray& trackNames)
+    {
+        stop();
+
+        stream = traceFile.createOutputStream();
+        if ( stream == nullptr )
+            return;
+
+        stream->setPosition(0);
+        stream->truncate();
+
+        names = stageNames;
+        history.assign(static_cast<size_t>(names.size()), {});
+        historyPos.assign(history.size(), 0);
+
+        {
+            const juce::ScopedLock lock(statsLock);
+            stats.assign(history.size(), {});
+        }
+
+        for ( size_t i = 0; i < events.size(); ++i )
+            events[i].sequence.store(i, std::memory_order_relaxed);
+
+        writePos.store(0, std::memory_order_relaxed);
+        readPos = 0;
+        dropped.store(0, std::memory_order_relaxed);
+        startTicks = now();
+
+        *stream << "[\n";
+
+        for ( auto track = 0; track < trackNames.size(); ++track )
+            *stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << track
+                    << ",\"args\":{\"name\":" << juce::JSON::toString(trackNames[track]) << "}},\n";
+
+       #if JUCE_MAJOR_VERSION >= 7
+        writer.startThread(juce::Thread::Priority::low);
+       #else
+        writer.startThread(3);
+       #endif
+    }
+
+    void stop()
+    {
+        writer.stopThread(1000);
+
+        if ( stream == nullptr )
+            return;
+
+        drain();
+
+        // an event with no comma after it, so the array closes cleanly
+        *stream << "{\"name\":\"dropped events\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":"
+                << juce::String(toMicroseconds(now()), 1) << ",\"args\":{\"count\":" << juce::String(static_cast<juce::int64>(dropped.load())) << "}}\n]\n";
+
+        stream.reset();
+    }
+
+    bool isRunning() const { return stream != nullptr; }
+
+    Stats getStats(int stage) const
+    {
+        const juce::ScopedLock lock(statsLock);
+        return juce::isPositiveAndBelow(stage, static_cast<int>(stats.size())) ? stats[static_cast<size_t>(stage)] : Stats {};
+    }
+
+    static juce::int64 now() noexcept
+    {
+        return juce::Time::getHighResolutionTicks();
+    }
+
+    // any thread, never blocks and never allocates
+    void record(int stage, int track, juce::int64 begin, juce::int64 end) noexcept
+    {
+        auto pos = writePos.load(std::memory_order_relaxed);
+
+        for ( ;; )
+        {
+            auto& slot = events[pos & mask];
+            auto lag = static_cast<juce::int64>(slot.sequence.load(std::memory_order_acquire) - pos);
+
+            if ( lag == 0 )
+            {
+                if ( writePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed) )
+                {
+                    slot.stage = stage;
+                    slot.track = track;
+                    slot.begin = begin;
+                    slot.end = end;
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return;
+                }
+            }
+            else if ( lag < 0 )
+            {
+                // the writer is a whole queue behind
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            else
+            {
+                pos = writePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    struct Scope
+    {
+        Scope(Profiler& p, int s, int t = 0) noexcept : profiler(p), stage(s), track(t), begin(now()) {}
+
+        ~Scope()
+        {
+            profiler.record(stage, track, begin, now());
+        }
+
+        Profiler& profiler;
+        const int stage, track;
+        const juce::int64 begin;
+    };
+
+private:
+    struct Writer : juce::Thread
+    {
+        Writer(Profiler& p) : juce::Thread("Profiler"), profiler(p) {}
+
+        void run() override
+        {
+            auto lastStats = now();
+
+            while ( !threadShouldExit() )
+            {
+                wait(20);
+                profiler.drain();
+
+                if ( juce::Time::highResolutionTicksToSeconds(now() - lastStats) >= 1.0 )
+                {
+                    lastStats = now();
+                    profiler.updateStats();
+                }
+            }
+        }
+
+        Profiler& profiler;
+    };
+
+    struct Event
+    {
+        std::atomic<uint64_t> sequence { 0 };
+        int stage { 0 }, track { 0 };
+        juce::int64 begin { 0 }, end { 0 };
+    };
+
+    static constexpr size_t capacity = 1 << 14;
+    static constexpr size_t mask = capacity - 1;
+    static constexpr size_t statsHistory = 2048;
+
+    double toMicroseconds(juce::int64 ticks) const
+    {
+        return juce::Time::highResolutionTicksToSeconds(ticks - startTicks) * 1.0e6;
+    }
+
+    // writer thread (or stop() once it has finished), the only consumer
+    void drain()
+    {
+        for ( ;; )
+        {
+            auto& slot = events[readPos & mask];
+            if ( slot.sequence.load(std::memory_order_acquire) != readPos + 1 )
+                return;
+
+            auto stage = slot.stage, track = slot.track;
+            auto begin = slot.begin, end = slot.end;
+
+            // hand the slot back for the producers' next lap
+            slot.sequence.store(readPos + capacity, std::memory_order_release);
+            ++readPos;
+
+            if ( !juce::isPositiveAndBelow(stage, names.size()) )
+                continue;
+
+            auto durationUs = juce::Time::highResolutionTicksToSeconds(end - begin) * 1.0e6;
+
+            *stream << "{\"name\":" << juce::JSON::toString(names[stage]) << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << track
+                    << ",\"ts\":" << juce::String(toMicroseconds(begin), 3) << ",\"dur\":" << juce::String(durationUs, 3) << "},\n";
+
+            auto s = static_cast<size_t>(stage);
+            if ( history[s].size() < statsHistory )
+                history[s].push_back(static_cast<float>(durationUs));
+            else
+                history[s][historyPos[s]] = static_cast<float>(durationUs);
+
+            historyPos[s] = (historyPos[s] + 1) % statsHistory;
+        }
+    }
+
+    void updateStats()
+    {
+        auto ts = juce::String(toMicroseconds(now()), 1);
+
+        for ( size_t s = 0; s < history.size(); ++s )
+        {
+            if ( history[s].empty() )
+                continue;
+
+            sorted = history[s];
+            std::sort(sorted.begin(), sorted.end());
+
+            Stats st;
+            st.count = static_cast<int>(sorted.size());
+            st.minUs = sorted.front();
+            st.meanUs = std::accumulate(sorted.begin(), sorted.end(), 0.0) / st.count;
+            st.p99Us = sorted[std::min(sorted.size() - 1, sorted.size() * 99 / 100)];
+
+            {
+                const juce::ScopedLock lock(statsLock);
+                stats[s] = st;
+            }
+
+            *stream << "{\"name\":" << juce::JSON::toString(names[static_cast<int>(s)] + " (us)") << ",\"ph\":\"C\",\"pid\":1,\"ts\":" << ts
+                    << ",\"args\":{\"min\":" << juce::String(st.minUs, 2) << ",\"mean\":" << juce::String(st.meanUs, 2)
+                    << ",\"p99\":" << juce::String(st.p99Us, 2) << "}},\n";
+        }
+
+        stream->flush();
+    }
+
+    std::array<Event, capacity> events;
+    std::atomic<uint64_t> writePos { 0 };
+    uint64_t readPos { 0 };
+    std::atomic<uint64_t> dropped { 0 };
+
+    juce::int64 startTicks { 0 };
+    juce::StringArray names;
+    std::unique_ptr<juce::FileOutputStream> stream;
+
+    // writer thread only
+    std::vector<std::vector<float>> history;
+    std::vector<size_t> historyPos;
+    std::vector<float> sorted;
+
+    juce::CriticalSection statsLock;
+    std::vector<Stats> stats;
+
+    Writer writer;
+};
+
+// times the rest of the enclosing block as one stage
+#define MBCOMP_PROFILE(profiler, ...) Profiler::Scope JUCE_JOIN_MACRO(profileScope, __LINE__) (profiler, __VA_ARGS__)
+
+#else
+
+#define MBCOMP_PROFILE(profiler, ...)
+
+#endif
@@ -0,0 +1,120 @@
+/*
+  ==============================================================================
+
+    Rendering.h
+    Created: 17 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// grey border around a navy rounded panel, behind the editor and every band
+inline void drawPanelBackground(juce::Graphics& g, juce::Rectangle<int> bounds)
+{
+    auto grey = juce::Colour(48u, 54u, 61u);
+    auto navy = juce::Colour(13u, 17u, 23u);
+
+    g.setColour(grey); // grey for border
+    g.fillRect(bounds);
+
+    bounds.reduce(3, 2);
+    g.setColour(navy); // navy for fill
+    g.fillRoundedRectangle(bounds.toFloat(), 3);
+}
+
+/*
+    Drawing that only changes with the component's size, rendered once into an image
+    at the display's pixel scale and blitted from then on. Opaque, the render has to
+    cover the whole area.
+*/
+struct CachedBackground
+{
+    // draws the cached image over bounds, calling render(g, area) to redo it first
+    // when the size or the display scale changed
+    template<typename Fn>
+    void draw(juce::Graphics& g, juce::Rectangle<int> bounds, Fn&& render)
+    {
+        auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+        auto width = juce::jmax(1, juce::roundToInt(static_cast<float>(bounds.getWidth()) * scale));
+        auto height = juce::jmax(1, juce::roundToInt(static_cast<float>(bounds.getHeight()) * scale));
+
+        if ( image.isNull() || image.getWidth() != width || image.getHeight() != height )
+        {
+            image = juce::Image(juce::Image::RGB, width, height, false);
+
+            juce::Graphics ig(image);
+            ig.addTransform(juce::AffineTransform::scale(scale));
+            render(ig, bounds.withZeroOrigin());
+        }
+
+        g.drawImage(image, bounds.toFloat());
+    }
+
+    // the next draw() renders again, for anything other than a resize that changes it
+    void invalidate() { image = {}; }
+
+private:
+    juce::Image image;
+};
+
+/*
+    Message thread time spent refreshing and painting meters, across every open editor
+    in the process - they all share the one message thread.
+
+    Paints and refresh callbacks add their time with a Scope. Once a second the total
+    becomes the load, the share of that second it took, and each MeterRefresh slows
+    down while the load is over budget and speeds back up once it's well under. A
+    session with dozens of editors open settles on a rate the machine can keep up
+    with, rather than every editor going flat out and starving the rest of the UI.
+*/
+struct FrameBudget
+{
+    // share of the message thread the meters may use between them
+    static constexpr double budget = 0.2;
+
+    struct Scope
+    {
+        Scope() : start(now()) {}
+        ~Scope() { getState().spent += now() - start; }
+
+        const double start;
+    };
+
+    // the load over the last full second, and that second's number so callers
+    // can tell when there's a new one
+    static double getLoad(int& window)
+    {
+        auto& state = getState();
+        auto time = now();
+
+        if ( time - state.windowStart >= 1.0 )
+        {
+            state.load = state.spent / (time - state.windowStart);
+            state.spent = 0.0;
+            state.windowStart = time;
+            ++state.window;
+        }
+
+        window = state.window;
+        return state.load;
+    }
+
+private:
+    struct State
+    {
+        double windowStart { now() }, spent { 0.0 }, load { 0.0 };
+        int window { 0 };
+    };
+
+    // message thread only, shared by every instance of the plugin in the process
+    static State& getState()
+    {
+        static State state;
+        return state;
+    }
+
+    static double now() { return juce::Time::getMillisecondCounterHiRes() * 0.001; }
+};
@@ -0,0 +1,224 @@
+/*
+  ==============================================================================
+
+    WorkerPool.h
+    Created: 16 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#endif
+
+/*
+    Fork/join pool for splitting a block's work across cores from the audio thread.
+
+    run(numTasks, fn) calls fn(0) ... fn(numTasks - 1) spread over the workers and the
+    calling thread, and returns once all of them are done. No allocation, and the
+    only lock is the one in waking a worker that has gone to sleep:
+
+    - a job is published by bumping a generation counter packed together with the
+      next task index into one atomic, so a worker still looking at an old job can
+      never claim a task of the new one
+    - the caller claims tasks like any worker, so a job finishes even if no worker
+      wakes up in time, and then spins until the tasks the workers took are done
+
+    After a job a worker spins for spinCount pauses, in case another one follows
+    straight away, then sleeps on its thread event until run() notifies it. Between
+    host blocks the workers sleep rather than holding their cores. Until start()
+    there are no workers at all and run() calls every task itself.
+*/
+struct WorkerPool
+{
+    WorkerPool() = default;
+
+    ~WorkerPool()
+    {
+        stop();
+    }
+
+    // threads are created and destroyed here, call these from the message thread, not the
+    // audio thread. A run() already going when the pool stops finishes its tasks itself.
+    // Workers aren't pinned to cores, with several instances in a session fixed cores
+    // would put every instance's workers on the same few
+    void start(int numWorkers)
+    {
+        stop();
+
+        for ( auto i = 0; i < numWorkers; ++i )
+        {
+            auto* worker = workers.add(new Worker(*this, i));
+
+           #if JUCE_MAJOR_VERSION >= 7
+            worker->startThread(juce::Thread::Priority::highest);
+           #else
+            worker->startThread(10);
+           #endif
+        }
+
+        running.store(!workers.isEmpty(), std::memory_order_release);
+    }
+
+    void stop()
+    {
+        running.store(false);
+
+        // a run() that saw the pool running may still be notifying the workers
+        while ( activeRuns.load() > 0 )
+            std::this_thread::yield();
+
+        for ( auto* worker : workers )
+            worker->signalThreadShouldExit();
+
+        workers.clear();
+    }
+
+    bool isRunning() const { return running.load(std::memory_order_acquire); }
+
+    template<typename Fn>
+    void run(int numTasks, Fn& fn)
+    {
+        // counted before looking, so stop() can't take the workers away while they're notified
+        ++activeRuns;
+
+        if ( !isRunning() || numTasks <= 1 )
+        {
+            --activeRuns;
+
+            for ( auto i = 0; i < numTasks; ++i )
+                fn(i);
+
+            return;
+        }
+
+        task = [](void* context, int index) { (*static_cast<Fn*>(context))(index); };
+        taskContext = &fn;
+        taskCount.store(numTasks, std::memory_order_relaxed);
+        remaining.store(numTasks, std::memory_order_relaxed);
+
+        // publishing the new generation releases everything written above
+        auto generation = (state.load(std::memory_order_relaxed) >> 32) + 1;
+        state.store(generation << 32, std::memory_order_release);
+
+        // pairs with the fence in Worker::run(), either the worker sees the new generation
+        // before it sleeps or this sees it asleep and wakes it
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        for ( auto* worker : workers )
+            if ( worker->asleep.load(std::memory_order_relaxed) )
+                worker->notify();
+
+        --activeRuns;
+
+        work(static_cast<uint32_t>(generation));
+
+        while ( remaining.load(std::memory_order_acquire) > 0 )
+            pause();
+    }
+
+private:
+    struct Worker : juce::Thread
+    {
+        Worker(WorkerPool& p, int index) : juce::Thread("Band Worker " + juce::String(index)), pool(p) {}
+
+        ~Worker() override
+        {
+            stopThread(1000);
+        }
+
+        void run() override
+        {
+            uint32_t seen = 0;
+            auto spins = 0;
+
+            while ( !threadShouldExit() )
+            {
+                auto generation = static_cast<uint32_t>(pool.state.load(std::memory_order_acquire) >> 32);
+
+                if ( generation != seen )
+                {
+                    seen = generation;
+                    pool.work(generation);
+                    spins = 0;
+                    continue;
+                }
+
+                if ( spins < spinCount )
+                {
+                    ++spins;
+                    pause();
+                    continue;
+                }
+
+                asleep.store(true, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+
+                // a job published before the fence would otherwise wait for the next notify
+                if ( static_cast<uint32_t>(pool.state.load(std::memory_order_acquire) >> 32) == seen )
+                    wait(-1);
+
+                asleep.store(false, std::memory_order_relaxed);
+                spins = 0;
+            }
+        }
+
+        WorkerPool& pool;
+        std::atomic<bool> asleep { false };
+    };
+
+    // claims and runs tasks of the given generation until there are none left
+    void work(uint32_t generation)
+    {
+        for ( ;; )
+        {
+            auto current = state.load(std::memory_order_acquire);
+
+            if ( static_cast<uint32_t>(current >> 32) != generation )
+                return;
+
+            auto index = static_cast<int>(current & 0xffffffffu);
+            if ( index >= taskCount.load(std::memory_order_relaxed) )
+                return;
+
+            if ( !state.compare_exchange_weak(current, current + 1, std::memory_order_acq_rel) )
+                continue;
+
+            // the job can't be replaced while this task is outstanding, so task and
+            // taskContext still belong to the generation that was claimed
+            task(taskContext, index);
+            remaining.fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    static void pause()
+    {
+       #if JUCE_INTEL
+        _mm_pause();
+       #else
+        std::this_thread::yield();
+       #endif
+    }
+
+    // a few tens of microseconds, long enough for jitter between back to back jobs,
+    // far shorter than any host block
+    static constexpr int spinCount = 1000;
+
+    // generation in the high 32 bits, next unclaimed task index in the low 32
+    std::atomic<uint64_t> state { 0 };
+    std::atomic<int> remaining { 0 };
+
+    void (*task)(void*, int) { nullptr };
+    void* taskContext { nullptr };
+    std::atomic<int> taskCount { 0 };
+
+    // workers is only changed by start() and stop(), and only while running is false
+    // and no run() is between its two activeRuns updates
+    std::atomic<bool> running { false };
+    std::atomic<int> activeRuns { 0 };
+    juce::OwnedArray<Worker> workers;
+};